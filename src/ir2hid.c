@@ -4,10 +4,21 @@
 #include <input/input.h>
 #include <infrared_worker.h>
 #include <infrared.h>
-#include <storage/storage.h>
-#include <lib/toolbox/hex.h>
+#include <notification/notification_messages.h>
 #include <string.h>
 
+#include "ir2hid_bench.h"
+#include "ir2hid_capture.h"
+#include "ir2hid_dispatch.h"
+#include "ir2hid_hid.h"
+#include "ir2hid_ir_rx.h"
+#include "ir2hid_ir_tx.h"
+#include "ir2hid_lut.h"
+#include "ir2hid_lut_pages.h"
+#include "ir2hid_timer_wheel.h"
+
+#define TAG "IR2HID"
+
 // --- Data Structures ---
 
 typedef enum {
@@ -20,297 +31,1044 @@ typedef struct {
     EventType type;
     union {
         InputEvent input;
-        InfraredMessage ir_message;
+        struct {
+            InfraredMessage ir_message;
+            uint32_t ir_cycles; // DWT->CYCCNT when the IR worker decoded it
+            bool ir_dispatched; // lookup + HID already done by the dispatch thread
+            IR2HIDLutRow ir_row; // set when ir_dispatched
+        };
     };
 } AppEvent;
 
+typedef enum {
+    IR2HIDScreenMain,
+    IR2HIDScreenStats,
+    IR2HIDScreenBench,
+    IR2HIDScreenCapture, // unmapped codes are collected while shown
+    IR2HIDScreenCount,
+} IR2HIDScreen;
+
+// Dispatch thread flags
+#define IR2HID_DISPATCH_FLAG_FRAME (1 << 0)
+#define IR2HID_DISPATCH_FLAG_EXIT (1 << 1)
+#define IR2HID_DISPATCH_FLAG_TIMINGS (1 << 2) // raw IR timings, early commit only
+
+// Lines visible at once on the stats screen
+#define IR2HID_STATS_VISIBLE_LINES 5
+
+// Stats screen redraw while shown, HID report rates are per this window
+#define IR2HID_STATS_REFRESH_MS 1000
+
+// Launch to HID connected is timed to this resolution
+#define IR2HID_USB_READY_POLL_MS 5
+
+// Synthetic LUT sizes the benchmark screen cycles through, then all of them at
+// once against the baseline. A run needs ~160 bytes of heap per row, 1000 rows
+// are already more than an app has free.
+static const size_t ir2hid_bench_sizes[] = {20, 100, 250, 500};
+#define IR2HID_BENCH_SWEEP COUNT_OF(ir2hid_bench_sizes)
+
+typedef enum {
+    IR2HIDBenchBaselineNone,
+    IR2HIDBenchBaselineSaved, // the last sweep, OK after a sweep without one
+    IR2HIDBenchBaselineFailed,
+} IR2HIDBenchBaseline;
+
+typedef enum {
+    IR2HIDBenchStateIdle,
+    IR2HIDBenchStateDone,
+    IR2HIDBenchStateSweepDone,
+    IR2HIDBenchStateNoMemory,
+} IR2HIDBenchState;
+
+typedef enum {
+    IR2HIDCaptureSaveNone,
+    IR2HIDCaptureSaveOk,
+    IR2HIDCaptureSaveFailed,
+} IR2HIDCaptureSave;
+
+// What the capture screen draws, copied out of the set so the draw never waits on dispatch
+typedef struct {
+    size_t count;
+    size_t last;
+    IR2HIDCaptureEntry entry; // the latest hit, valid if count > 0
+    uint32_t dropped;
+} IR2HIDCaptureView;
+
 typedef struct {
-    InfraredMessage ir;
-    uint8_t hid_code;
-} IR2HIDLutEntry;
+    uint32_t frames; // IR frames that passed debounce
+    uint32_t headless_frames; // frames handled while headless
+    uint32_t redraws; // view_port_update calls
+    uint32_t ui_frames; // frames that went through the UI update on the main loop
+    uint64_t ui_cycles; // CPU cycles spent on those, under mutex
+    uint64_t draw_cycles; // signal screen draw callbacks, under mutex
+    uint32_t lookups;
+    uint32_t mru_hits; // lookups answered by the MRU cache
+    uint32_t cooldown_skips; // mapped frames dropped while their row was cooling down
+    uint32_t early_commits; // NEC codes dispatched before their frame ended
+    uint32_t early_cancels; // of which the frame broke off or decoded to another code
+} IR2HIDStats;
+
+// Recently looked up keys, in front of the binary search
+#define IR2HID_MRU_SIZE 2
+#define IR2HID_MRU_EMPTY UINT64_MAX // never a valid key, protocol 0xFF doesn't exist
+
+typedef struct {
+    IR2HIDKey key;
+    IR2HIDLutRow row; // copy, action is IR2HID_LUT_NO_ACTION for a cached miss
+    uint32_t index;
+} IR2HIDMruEntry;
 
 typedef struct {
     FuriMessageQueue* event_queue;
     FuriMutex* mutex;
     Gui* gui;
     ViewPort* view_port;
+    NotificationApp* notifications;
     InfraredWorker* ir_worker;
+
+    // UI
+    IR2HIDScreen screen;
+    uint8_t stats_scroll;
+    IR2HIDTimer stats_timer; // only pending while the stats screen is shown
+    bool headless; // display off, main loop only does lookup + HID dispatch
+    IR2HIDStats stats;
+    IR2HIDTimer redraw_timer;
+    uint32_t redraw_tick; // last signal redraw
+    bool redraw_done; // at least one signal redraw happened
+
+    // Benchmark screen
+    uint8_t bench_size;
+    IR2HIDBenchState bench_state;
+    bool bench_saved;
+    IR2HIDBenchReport bench_report;
+    IR2HIDBenchReport bench_sweep[IR2HID_BENCH_SWEEP];
+    size_t bench_sweep_count; // sizes that fit in RAM
+    IR2HIDBenchGate bench_gate;
+    IR2HIDBenchBaseline bench_baseline;
+
+    // Capture screen, the set is only touched under dispatch_mutex
+    IR2HIDCapture capture;
+    IR2HIDCaptureSave capture_save;
+    IR2HIDCaptureView capture_view; // under mutex, refreshed by the main loop
+
     
-    // VISUAL STATE: store text here so render_callback does ZERO logic
-    char text_proto[32];
-    char text_addr[32];
-    char text_cmd[32];
+    // VISUAL STATE: raw values of the last signal, render_callback formats them lazily
     bool has_signal;
+    InfraredMessage last_signal;
+    IR2HIDLutRow last_row; // action is IR2HID_LUT_NO_ACTION if the signal isn't mapped
+
+    // Status message shown until the first signal (e.g. LUT errors)
+    bool has_status;
+    char text_status[3][32];
     
     // LUT
-    IR2HIDLutEntry* lut;
-    size_t lut_count;
+    IR2HIDLut lut;
+    IR2HIDMruEntry mru[IR2HID_MRU_SIZE]; // most recent first
 
     // USB HID
     FuriHalUsbInterface* usb_prev_if;
     bool usb_hid_active;
+    bool usb_hid_reused; // HID was already configured at launch, no re-enumeration
+    bool usb_hid_keep; // leave HID configured on exit
+    IR2HIDHidQueue* hid_queue;
+    IR2HIDHidMeter hid_meter; // snapshot at hid_meter_tick
+    uint32_t hid_meter_tick;
+    uint32_t hid_queued_rate; // reports/s over the last stats refresh
+    uint32_t hid_sent_rate;
+    uint32_t hid_wait_ms; // average press wait in the queue
+
+    // IR relay, NULL once shutting down
+    IR2HIDIrTx* ir_tx;
+
+    // HID dispatch thread, lookup + HID reports away from UI work
+    FuriThread* dispatch_thread;
+    IR2HIDIrRing ir_ring; // from the IR worker
+    FuriMutex* dispatch_mutex; // held around each dispatch, both paths can run while switching
+    volatile bool dispatch_split; // IR frames go to the dispatch thread, not the main loop
+    IR2HIDLatency latency_thread;
+    IR2HIDLatency latency_loop;
+
+    // Early NEC commit, NULL when the InfraredWorker receives
+    IR2HIDIrRx* ir_rx;
+    bool early_pending; // committed, waiting for the end of the frame, dispatch thread only
+    IR2HIDLatency early_saved; // commit to full frame decode
+
+    // Timeouts of every kind, EventTypeTick drives it from the main loop
+    IR2HIDTimerWheel* timers;
+    volatile bool tick_pending; // set by the timer thread, the main loop advances
+
+    // Launch to the host accepting reports, shows what reusing the HID session saves
+    uint32_t start_tick;
+    IR2HIDTimer usb_ready_timer; // polls until connected
+    bool usb_ready;
+    uint32_t usb_ready_ms;
 
     // Simple IR debounce
     InfraredProtocol last_proto;
     uint32_t last_addr;
     uint32_t last_cmd;
     uint32_t last_tick;
+
+    // Auto-repeat of the last key sent while its button is held, under dispatch_mutex
+    uint16_t repeat_code; // 0 if the last row can't repeat
+    uint32_t repeat_since; // tick of the first press
+    uint32_t repeat_last; // tick of the last keystroke sent
 } IR2HIDApp;
 
-// --- Helpers ---
+// --- LUT Loading ---
 
-// Strip 0x/0X prefix from a hex string
-static const char* ir2hid_strip_hex_prefix(const char* s) {
-    if(s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
-        return s + 2;
+static void ir2hid_set_status_text(
+    IR2HIDApp* app,
+    const char* proto,
+    const char* addr,
+    const char* cmd) {
+    furi_mutex_acquire(app->mutex, FuriWaitForever);
+    strlcpy(app->text_status[0], proto, sizeof(app->text_status[0]));
+    strlcpy(app->text_status[1], addr, sizeof(app->text_status[1]));
+    strlcpy(app->text_status[2], cmd, sizeof(app->text_status[2]));
+    app->has_status = true;
+    furi_mutex_release(app->mutex);
+}
+
+static void ir2hid_load_lut(IR2HIDApp* app) {
+    IR2HIDLutStatus status = ir2hid_lut_load(&app->lut);
+
+    if(status == IR2HIDLutStatusNotFound) {
+        // Could not open/find LUT, display error
+        ir2hid_set_status_text(app, "lut.csv not found", "", "");
+    } else if(status == IR2HIDLutStatusOutdated) {
+        ir2hid_set_status_text(app, "lut.bin outdated,", "run lut2bin.py", "again");
+    } else if(app->lut.duplicates || app->lut.conflicts) {
+        char summary[32];
+        char first[32];
+        snprintf(
+            summary,
+            sizeof(summary),
+            "%zu dup, %zu conflict",
+            app->lut.duplicates,
+            app->lut.conflicts);
+        snprintf(
+            first,
+            sizeof(first),
+            "line %u vs line %u",
+            app->lut.first_issue_line,
+            app->lut.first_issue_kept_line);
+        ir2hid_set_status_text(app, summary, first, "Details in lut.log");
     }
-    return s;
 }
 
-// Parse variable-length hex string into uint32 using hex_char_to_hex_nibble function
-static bool ir2hid_parse_hex_u32(const char* s, uint32_t* out) {
-    uint32_t value = 0;
-    uint8_t nibble = 0;
-    bool any = false;
+// LUT row matching the signal. Remotes repeat the same button a lot, so the
+// last two keys are checked first with one compare each. Rows are cached by
+// value, so with a paged LUT a hit doesn't touch the page cache either.
+static bool ir2hid_lookup_hid_code(
+    IR2HIDApp* app,
+    const InfraredMessage* ir,
+    IR2HIDLutRow* row,
+    uint32_t* index) {
+    row->action = IR2HID_LUT_NO_ACTION;
+
+    IR2HIDKey key;
+    if(!ir2hid_key_from_message(ir, &key)) return false;
+
+    app->stats.lookups++;
+
+    IR2HIDMruEntry* mru = app->mru;
+    if(mru[0].key == key) {
+        app->stats.mru_hits++;
+        *row = mru[0].row;
+        *index = mru[0].index;
+        return row->action != IR2HID_LUT_NO_ACTION;
+    }
+    if(mru[1].key == key) {
+        app->stats.mru_hits++;
+        IR2HIDMruEntry hit = mru[1];
+        mru[1] = mru[0];
+        mru[0] = hit;
+        *row = hit.row;
+        *index = hit.index;
+        return row->action != IR2HID_LUT_NO_ACTION;
+    }
+
+    ir2hid_lut_lookup(&app->lut, key, row, index);
 
-    while(*s) {
-        if(!hex_char_to_hex_nibble(*s, &nibble)) {
-            return false;
+    mru[1] = mru[0];
+    mru[0].key = key;
+    mru[0].row = *row;
+    mru[0].index = *index;
+
+    return row->action != IR2HID_LUT_NO_ACTION;
+}
+
+// Early NEC commit: mapped codes a frame can still decode to. Runs on the
+// dispatch thread between timings, the LUT may be reloading on the main thread.
+static size_t ir2hid_early_match(
+    void* context,
+    const InfraredMessage* pattern,
+    uint32_t command_mask,
+    InfraredMessage* match) {
+    IR2HIDApp* app = context;
+    IR2HIDKey key;
+    if(!ir2hid_key_from_message(pattern, &key)) return 0;
+
+    furi_mutex_acquire(app->dispatch_mutex, FuriWaitForever);
+    const size_t count = ir2hid_lut_match_prefix(&app->lut, key, command_mask, &key);
+    furi_mutex_release(app->dispatch_mutex);
+
+    if(count > 0) {
+        match->protocol = ir2hid_key_protocol(key);
+        match->address = ir2hid_key_address(key);
+        match->command = ir2hid_key_command(key);
+        match->repeat = false;
+    }
+    return count;
+}
+
+// --- IR Worker Callback ---
+
+// Hands a decoded frame to the dispatch thread, or copies it to the main Queue
+static void ir2hid_ir_frame_push(IR2HIDApp* app, const InfraredMessage* msg, uint32_t cycles) {
+    if(app->dispatch_split) {
+        IR2HIDIrFrame frame = {.message = *msg, .cycles = cycles};
+        if(ir2hid_ir_ring_push(&app->ir_ring, &frame)) {
+            furi_thread_flags_set(
+                furi_thread_get_id(app->dispatch_thread), IR2HID_DISPATCH_FLAG_FRAME);
         }
-        value = (value << 4) | nibble;
-        any = true;
-        s++;
+    } else {
+        AppEvent event;
+        event.type = EventTypeIRSignal;
+        event.ir_message = *msg; 
+        event.ir_cycles = cycles;
+        event.ir_dispatched = false;
+        furi_message_queue_put(app->event_queue, &event, 0);
     }
+}
 
-    if(!any) return false;
-    *out = value;
-    return true;
+// Runs in background thread
+static void ir_worker_callback(void* context, InfraredWorkerSignal* signal) {
+    IR2HIDApp* app = (IR2HIDApp*)context;
+
+    // 1. Decodes signal
+    const InfraredMessage* msg = infrared_worker_get_decoded_signal(signal);
+    
+    // 2. Hands the signal on, don't make GUI changes to avoid race conditions
+    if(msg) ir2hid_ir_frame_push(app, msg, DWT->CYCCNT);
 }
 
-// --- LUT Loading ---
+// --- GUI Rendering ---
 
-static bool ir2hid_parse_lut_line(const char* line, IR2HIDLutEntry* entry) {
-    // Expected CSV:
-    // ir_protocol,ir_address,ir_command,hid_command,ir_key_comment,hid_key_comment
-    const size_t MaxColumns = 4; // ignore the rest as col 5-6 are comments
-    const char* cols[4] = {0};
-    size_t col_index = 0;
-
-    const char* p = line;
-    cols[col_index] = p;
-    while(*p && col_index < MaxColumns) {
-        if(*p == ',') {
-            // terminate current column
-            ((char*)p)[0] = '\0';
-            col_index++;
-            if(col_index < MaxColumns) {
-                cols[col_index] = p + 1;
-            }
+static void ir2hid_format_jitter(
+    const char* name,
+    const IR2HIDLatency* latency,
+    char* out,
+    size_t out_size) {
+    uint32_t p50, p99;
+    if(ir2hid_latency_percentiles(latency, &p50, &p99)) {
+        snprintf(out, out_size, "%s: %lu/%lu us, jit %lu", name, p50, p99, p99 - p50);
+    } else {
+        snprintf(out, out_size, "%s: -", name);
+    }
+}
+
+// Format one line of the stats screen, returns false past the last line
+static bool ir2hid_stats_format_line(IR2HIDApp* app, size_t index, char* out, size_t out_size) {
+    // The cycle counts are 64 bit and written from the main loop and the GUI thread
+    IR2HIDStats snapshot;
+    furi_mutex_acquire(app->mutex, FuriWaitForever);
+    snapshot = app->stats;
+    furi_mutex_release(app->mutex);
+    const IR2HIDStats* stats = &snapshot;
+    const uint32_t frames = stats->frames ? stats->frames : 1;
+
+    switch(index) {
+    case 0:
+        snprintf(out, out_size, "Frames: %lu (headless %lu)", stats->frames, stats->headless_frames);
+        break;
+    case 1:
+        snprintf(out, out_size, "Redraws/1k frames: %lu", stats->redraws * 1000 / frames);
+        break;
+    case 2:
+        // Every headless frame is a GUI thread wakeup that didn't happen
+        snprintf(
+            out, out_size, "Wakeups saved/1k: %lu", stats->headless_frames * 1000 / frames);
+        break;
+    case 3: {
+        // Main loop UI update plus the draws it caused, per frame. The display
+        // transfer after the draw callback happens in the GUI service and isn't counted.
+        uint64_t saved_us = 0;
+        if(stats->ui_frames) {
+            saved_us = (stats->ui_cycles + stats->draw_cycles) * stats->headless_frames * 1000 /
+                       stats->ui_frames / frames /
+                       furi_hal_cortex_instructions_per_microsecond();
+        }
+        snprintf(out, out_size, "CPU saved/1k: %lu us", (uint32_t)saved_us);
+        break;
+    }
+    case 4:
+        snprintf(
+            out,
+            out_size,
+            "MRU hits: %lu%% (%lu/%lu)",
+            stats->lookups ? stats->mru_hits * 100 / stats->lookups : 0,
+            stats->mru_hits,
+            stats->lookups);
+        break;
+    case 5:
+        if(app->usb_ready) {
+            snprintf(
+                out,
+                out_size,
+                "HID up: %lu ms (%s)",
+                app->usb_ready_ms,
+                app->usb_hid_reused ? "reused" : "enum");
+        } else {
+            snprintf(out, out_size, "HID up: -");
         }
-        p++;
+        break;
+    case 6:
+        snprintf(
+            out, out_size, "Dispatch: %s [OK]", app->dispatch_split ? "thread" : "main loop");
+        break;
+    case 7:
+        // IR decode to HID dispatch, p50/p99 of the last keystrokes on each path
+        ir2hid_format_jitter("Thread", &app->latency_thread, out, out_size);
+        break;
+    case 8:
+        ir2hid_format_jitter("Loop", &app->latency_loop, out, out_size);
+        break;
+    case 9:
+        if(app->ir_rx) {
+            snprintf(
+                out,
+                out_size,
+                "Early NEC: %lu, %lu cancel",
+                stats->early_commits,
+                stats->early_cancels);
+        } else {
+            snprintf(out, out_size, "Early NEC: off");
+        }
+        break;
+    case 10: {
+        // How much sooner keys went out than with the full frame
+        uint32_t p50, p99;
+        if(ir2hid_latency_percentiles(&app->early_saved, &p50, &p99)) {
+            snprintf(out, out_size, "Early saved: %lu/%lu us", p50, p99);
+        } else {
+            snprintf(out, out_size, "Early saved: -");
+        }
+        break;
+    }
+    case 11: {
+        uint32_t sent = 0, echoes = 0;
+        if(app->ir_tx) ir2hid_ir_tx_stats(app->ir_tx, &sent, &echoes);
+        snprintf(out, out_size, "IR relay: %lu sent, %lu echo", sent, echoes);
+        break;
+    }
+    case 12:
+        snprintf(out, out_size, "Cooldown skips: %lu", stats->cooldown_skips);
+        break;
+    case 13:
+        if(app->lut.pages) {
+            uint32_t hits, reads;
+            ir2hid_lut_pages_stats(&app->lut, &hits, &reads);
+            snprintf(out, out_size, "Pages: %lu hits, %lu reads", hits, reads);
+        } else {
+            snprintf(out, out_size, "LUT: %zu rows in RAM", app->lut.count);
+        }
+        break;
+    case 14:
+        // Sent below queued: the host polls slower than keys are coming
+        snprintf(
+            out, out_size, "HID/s: %lu sent, %lu queued", app->hid_sent_rate, app->hid_queued_rate);
+        break;
+    case 15:
+        snprintf(
+            out,
+            out_size,
+            "HID wait %lu ms, backlog %lu",
+            app->hid_wait_ms,
+            app->hid_meter.backlog);
+        break;
+    case 16:
+        snprintf(
+            out,
+            out_size,
+            "HID refused: %lu, %lu lost",
+            app->hid_meter.failed,
+            app->hid_meter.dropped);
+        break;
+    default:
+        return false;
     }
+    return true;
+}
 
-    if(col_index < MaxColumns - 1) return false;
+static void ir2hid_render_stats(Canvas* canvas, IR2HIDApp* app) {
+    char line[40];
+    for(size_t i = 0; i < IR2HID_STATS_VISIBLE_LINES; i++) {
+        if(!ir2hid_stats_format_line(app, app->stats_scroll + i, line, sizeof(line))) break;
+        canvas_draw_str(canvas, 2, 22 + i * 10, line);
+    }
+}
 
-    const char* proto_str = cols[0];
-    const char* addr_str = cols[1];
-    const char* cmd_str = cols[2];
-    const char* hid_str = cols[3];
+// Formatting happens here, only when the screen is actually redrawn
+static void ir2hid_render_signal(Canvas* canvas, IR2HIDApp* app) {
+    IR2HIDSignalText text;
+    const IR2HIDLutRow* row =
+        app->last_row.action == IR2HID_LUT_NO_ACTION ? NULL : &app->last_row;
+    ir2hid_lut_format_signal(&app->lut, &app->last_signal, row, &text);
+
+    canvas_draw_str(canvas, 2, 25, text.proto);
+    canvas_draw_str(canvas, 2, 37, text.addr);
+    canvas_draw_str(canvas, 2, 49, text.cmd);
+    if(text.comment[0]) {
+        canvas_draw_str(canvas, 2, 61, text.comment);
+    }
+}
+
+static void ir2hid_render_bench_sweep(Canvas* canvas, IR2HIDApp* app) {
+    const IR2HIDBenchGate* gate = &app->bench_gate;
+    char line[40];
+
+    snprintf(
+        line,
+        sizeof(line),
+        "Ran %zu of %zu sizes, up to %zu",
+        app->bench_sweep_count,
+        IR2HID_BENCH_SWEEP,
+        app->bench_sweep[app->bench_sweep_count - 1].rows);
+    canvas_draw_str(canvas, 2, 34, line);
+
+    if(app->bench_baseline == IR2HIDBenchBaselineSaved) {
+        canvas_draw_str(canvas, 2, 44, "Saved as new baseline");
+    } else if(app->bench_baseline == IR2HIDBenchBaselineFailed) {
+        canvas_draw_str(canvas, 2, 44, "Baseline save failed");
+    } else if(gate->baseline_missing) {
+        canvas_draw_str(canvas, 2, 44, "FAIL: no baseline");
+        canvas_draw_str(canvas, 2, 54, "[OK] save as baseline");
+    } else if(gate->worst_name) {
+        snprintf(
+            line,
+            sizeof(line),
+            "%s: %zu of %zu regressed",
+            gate->regressions ? "FAIL" : "PASS",
+            gate->regressions,
+            gate->compared);
+        canvas_draw_str(canvas, 2, 44, line);
+        snprintf(
+            line,
+            sizeof(line),
+            "Worst: %zu %s %lu%%",
+            gate->worst_rows,
+            gate->worst_name,
+            gate->worst_pct);
+        canvas_draw_str(canvas, 2, 54, line);
+    } else {
+        canvas_draw_str(canvas, 2, 44, "No baseline for these sizes");
+    }
+    canvas_draw_str(canvas, 2, 62, "Results in bench.csv");
+}
+
+static void ir2hid_render_bench(Canvas* canvas, IR2HIDApp* app) {
+    char line[40];
+    if(app->bench_size == IR2HID_BENCH_SWEEP) {
+        snprintf(line, sizeof(line), "Rows: all  [OK] run");
+    } else if(app->bench_state == IR2HIDBenchStateDone) {
+        // The results take every line below, the save status goes up here
+        snprintf(
+            line,
+            sizeof(line),
+            app->bench_saved ? "Rows: %zu  us/op, saved" : "Rows: %zu  save failed",
+            ir2hid_bench_sizes[app->bench_size]);
+    } else {
+        snprintf(
+            line, sizeof(line), "Rows: %zu  [OK] run", ir2hid_bench_sizes[app->bench_size]);
+    }
+    canvas_draw_str(canvas, 2, 22, line);
 
-    // Protocol
-    InfraredProtocol proto = infrared_get_protocol_by_name(proto_str);
-    if(!infrared_is_protocol_valid(proto)) return false;
+    if(app->bench_state == IR2HIDBenchStateSweepDone) {
+        ir2hid_render_bench_sweep(canvas, app);
+        return;
+    } else if(app->bench_state == IR2HIDBenchStateNoMemory) {
+        canvas_draw_str(canvas, 2, 34, "Not enough RAM");
+        return;
+    } else if(app->bench_state != IR2HIDBenchStateDone) {
+        canvas_draw_str(canvas, 2, 34, "Up/Down: LUT size");
+        return;
+    }
 
-    // Strip optional 0x/0X prefixes
-    addr_str = ir2hid_strip_hex_prefix(addr_str);
-    cmd_str = ir2hid_strip_hex_prefix(cmd_str);
-    hid_str = ir2hid_strip_hex_prefix(hid_str);
+    // Two results per line, in us/op, the last one alone if the count is odd
+    for(size_t op = 0; op < IR2HIDBenchOpCount; op += 2) {
+        const uint32_t ns_a = ir2hid_bench_ns_per_op(&app->bench_report.results[op]);
+        int len = snprintf(
+            line,
+            sizeof(line),
+            "%s %lu.%02lu",
+            ir2hid_bench_op_name(op),
+            ns_a / 1000,
+            ns_a % 1000 / 10);
+        if(op + 1 < IR2HIDBenchOpCount) {
+            const uint32_t ns_b = ir2hid_bench_ns_per_op(&app->bench_report.results[op + 1]);
+            snprintf(
+                line + len,
+                sizeof(line) - len,
+                " %s %lu.%02lu",
+                ir2hid_bench_op_name(op + 1),
+                ns_b / 1000,
+                ns_b % 1000 / 10);
+        }
+        canvas_draw_str(canvas, 2, 30 + op / 2 * 8, line);
+    }
+}
 
-    uint32_t addr_val = 0;
-    uint32_t cmd_val = 0;
-    uint32_t hid_val = 0;
+static void ir2hid_render_capture(Canvas* canvas, IR2HIDApp* app) {
+    char line[40];
 
-    if(!ir2hid_parse_hex_u32(addr_str, &addr_val)) return false;
-    if(!ir2hid_parse_hex_u32(cmd_str, &cmd_val)) return false;
-    if(!ir2hid_parse_hex_u32(hid_str, &hid_val)) return false;
-    if(hid_val > 0xFF) return false;
+    furi_mutex_acquire(app->mutex, FuriWaitForever);
+    const IR2HIDCaptureView view = app->capture_view;
+    furi_mutex_release(app->mutex);
 
-    memset(&entry->ir, 0, sizeof(entry->ir));
-    entry->ir.protocol = proto;
-    entry->ir.address = addr_val;
-    entry->ir.command = cmd_val;
-    entry->ir.repeat = false;
-    entry->hid_code = (uint8_t)hid_val;
+    snprintf(line, sizeof(line), "Unmapped: %zu  [OK] save", view.count);
+    canvas_draw_str(canvas, 2, 22, line);
+
+    if(view.count) {
+        const IR2HIDCaptureEntry* entry = &view.entry;
+        snprintf(
+            line,
+            sizeof(line),
+            "%s 0x%04lX 0x%04lX",
+            infrared_get_protocol_name(ir2hid_key_protocol(entry->key)),
+            ir2hid_key_address(entry->key),
+            ir2hid_key_command(entry->key));
+        canvas_draw_str(canvas, 2, 34, line);
+        snprintf(line, sizeof(line), "button %zu, %lu hits", view.last + 1, entry->hits);
+        canvas_draw_str(canvas, 2, 44, line);
+    } else {
+        canvas_draw_str(canvas, 2, 34, "Press every button once");
+    }
 
-    return true;
+    if(view.dropped) {
+        snprintf(line, sizeof(line), "Full, %lu codes dropped", view.dropped);
+    } else if(app->capture_save == IR2HIDCaptureSaveOk) {
+        snprintf(line, sizeof(line), "Saved capture.csv [Down] clear");
+    } else if(app->capture_save == IR2HIDCaptureSaveFailed) {
+        snprintf(line, sizeof(line), "Save failed");
+    } else {
+        snprintf(line, sizeof(line), "[Down] clear");
+    }
+    canvas_draw_str(canvas, 2, 62, line);
 }
 
-static void ir2hid_load_lut(IR2HIDApp* app) {
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-    File* file = storage_file_alloc(storage);
+static void render_callback(Canvas* canvas, void* ctx) {
+    IR2HIDApp* app = (IR2HIDApp*)ctx;
+    const uint32_t draw_start = DWT->CYCCNT;
 
-    // Path for `lut.csv` on the SD card: /ext/apps_data/ir2hid/lut.csv
-    const char* lut_path = EXT_PATH("apps_data/ir2hid/lut.csv");
+    canvas_clear(canvas);
 
-    if(!storage_file_open(file, lut_path, FSAM_READ, FSOM_OPEN_EXISTING)) {
-        // Could not open/find LUT, display error
-        storage_file_free(file);
-        furi_record_close(RECORD_STORAGE);
-
-        furi_mutex_acquire(app->mutex, FuriWaitForever);
-        strlcpy(app->text_proto, "lut.csv not found", sizeof(app->text_proto));
-        app->text_addr[0] = '\0';
-        app->text_cmd[0] = '\0';
-        app->has_signal = true;
-        furi_mutex_release(app->mutex);
+    if(app->headless) {
+        // Nothing else is ever redrawn while headless
+        canvas_set_font(canvas, FontSecondary);
+        canvas_draw_str(canvas, 2, 10, "Headless, hold OK to wake");
         return;
     }
 
-    // Get file size and allocate buffer
-    uint64_t file_size = storage_file_size(file);
-    if(file_size == 0 || file_size > 8192) { // Sanity check: max 8KB
-        storage_file_close(file);
-        storage_file_free(file);
-        furi_record_close(RECORD_STORAGE);
-        return;
+    canvas_set_font(canvas, FontPrimary);
+    
+    // Check USB HID connection status
+    bool hid_connected = app->usb_hid_active && furi_hal_hid_is_connected();
+    if(hid_connected) {
+        canvas_draw_str(canvas, 2, 10, "IR > HID [Connected]");
+    } else {
+        canvas_draw_str(canvas, 2, 10, "IR > HID");
     }
+    
+    canvas_draw_line(canvas, 0, 12, 128, 12);
+    canvas_set_font(canvas, FontSecondary);
 
-    char* buf = malloc((size_t)file_size + 1);
-    if(!buf) {
-        storage_file_close(file);
-        storage_file_free(file);
-        furi_record_close(RECORD_STORAGE);
+    if(app->screen == IR2HIDScreenStats) {
+        ir2hid_render_stats(canvas, app);
+        return;
+    } else if(app->screen == IR2HIDScreenBench) {
+        ir2hid_render_bench(canvas, app);
+        return;
+    } else if(app->screen == IR2HIDScreenCapture) {
+        ir2hid_render_capture(canvas, app);
         return;
     }
 
-    size_t read = storage_file_read(file, buf, (size_t)file_size);
-    buf[read] = '\0';
+    furi_mutex_acquire(app->mutex, FuriWaitForever);
 
-    storage_file_close(file);
-    storage_file_free(file);
-    furi_record_close(RECORD_STORAGE);
+    if(app->has_signal) {
+        ir2hid_render_signal(canvas, app);
+    } else if(app->has_status) {
+        canvas_draw_str(canvas, 2, 25, app->text_status[0]);
+        canvas_draw_str(canvas, 2, 37, app->text_status[1]);
+        canvas_draw_str(canvas, 2, 49, app->text_status[2]);
+    } else {
+        canvas_draw_str(canvas, 10, 35, "Waiting for signal...");
+    }
 
-    // First pass: split into lines (in-place) and count data lines (skip header)
-    size_t line_no = 0;
-    size_t data_lines = 0;
-    char* line_start = buf;
+    // Headless saves this draw for every frame, the other screens aren't counted
+    app->stats.draw_cycles += DWT->CYCCNT - draw_start;
+    furi_mutex_release(app->mutex);
+}
 
-    for(size_t i = 0; i <= read; i++) {
-        char c = buf[i];
-        if(c == '\r' || c == '\n' || c == '\0') {
-            buf[i] = '\0';
-            if(line_start[0] != '\0') {
-                if(line_no > 0) {
-                    data_lines++;
-                }
-                line_no++;
-            }
-            line_start = &buf[i + 1];
-        }
+// --- Timers ---
+
+// Timer thread: just wake the main loop, the wheel runs there. The flag is what
+// counts, when the queue is full the tick is dropped but the main loop has events
+// to handle and finds the flag after them. The wheel only re-arms on an advance.
+static void ir2hid_timer_wakeup(void* ctx) {
+    IR2HIDApp* app = ctx;
+    app->tick_pending = true;
+    AppEvent event = {.type = EventTypeTick};
+    furi_message_queue_put(app->event_queue, &event, 0);
+}
+
+static void ir2hid_redraw(IR2HIDApp* app) {
+    view_port_update(app->view_port);
+    app->redraw_tick = furi_get_tick();
+    app->redraw_done = true;
+    app->stats.redraws++;
+}
+
+static void ir2hid_redraw_timer_callback(void* ctx) {
+    IR2HIDApp* app = ctx;
+    if(!app->headless) ir2hid_redraw(app);
+}
+
+// New HID meter snapshot, rates are taken against the previous one if asked for
+static void ir2hid_hid_meter_sample(IR2HIDApp* app, bool rates) {
+    IR2HIDHidMeter meter;
+    ir2hid_hid_queue_meter(app->hid_queue, &meter);
+    const uint32_t now = furi_get_tick();
+    const uint32_t elapsed = now - app->hid_meter_tick;
+
+    if(rates && elapsed) {
+        const uint32_t frequency = furi_kernel_get_tick_frequency();
+        const uint32_t presses = meter.presses - app->hid_meter.presses;
+        app->hid_queued_rate = (meter.queued - app->hid_meter.queued) * frequency / elapsed;
+        app->hid_sent_rate = (meter.sent - app->hid_meter.sent) * frequency / elapsed;
+        app->hid_wait_ms =
+            presses ? (meter.wait_ticks - app->hid_meter.wait_ticks) * 1000 / frequency / presses :
+                      0;
     }
 
-    if(data_lines == 0) {
-        free(buf);
-        return;
+    app->hid_meter = meter;
+    app->hid_meter_tick = now;
+}
+
+static void ir2hid_stats_timer_callback(void* ctx) {
+    IR2HIDApp* app = ctx;
+    ir2hid_hid_meter_sample(app, true);
+    if(app->screen == IR2HIDScreenStats && !app->headless) {
+        view_port_update(app->view_port);
+        ir2hid_timer_schedule(app->timers, &app->stats_timer, IR2HID_STATS_REFRESH_MS);
     }
+}
 
-    IR2HIDLutEntry* lut = malloc(sizeof(IR2HIDLutEntry) * data_lines);
-    if(!lut) {
-        free(buf);
+// Until the host has configured the HID interface, i.e. the first report can go out.
+// With a reused session that is right away, otherwise the host enumerates first.
+static void ir2hid_usb_ready_timer_callback(void* ctx) {
+    IR2HIDApp* app = ctx;
+    if(!furi_hal_hid_is_connected()) {
+        ir2hid_timer_schedule(app->timers, &app->usb_ready_timer, IR2HID_USB_READY_POLL_MS);
         return;
     }
 
-    // Second pass: parse each data line into LUT
-    memset(lut, 0, sizeof(IR2HIDLutEntry) * data_lines);
-    size_t lut_index = 0;
-    line_no = 0;
-    line_start = buf;
-
-    for(size_t i = 0; i <= read && lut_index < data_lines; i++) {
-        if(buf[i] == '\0') {
-            if(line_start[0] != '\0') {
-                if(line_no > 0) {
-                    if(ir2hid_parse_lut_line(line_start, &lut[lut_index])) {
-                        lut_index++;
-                    }
-                }
-                line_no++;
+    app->usb_ready = true;
+    app->usb_ready_ms =
+        (furi_get_tick() - app->start_tick) * 1000 / furi_kernel_get_tick_frequency();
+    FURI_LOG_I(
+        TAG,
+        "HID ready %lu ms after launch (%s)",
+        app->usb_ready_ms,
+        app->usb_hid_reused ? "reused" : "enumerated");
+    if(app->screen == IR2HIDScreenStats && !app->headless) view_port_update(app->view_port);
+}
+
+// Refresh the stats screen while it's shown, nothing wakes up otherwise
+static void ir2hid_stats_timer_update(IR2HIDApp* app) {
+    if(app->screen != IR2HIDScreenStats || app->headless) {
+        ir2hid_timer_cancel(app->timers, &app->stats_timer);
+    } else if(!ir2hid_timer_is_pending(&app->stats_timer)) {
+        ir2hid_hid_meter_sample(app, false);
+        ir2hid_timer_schedule(app->timers, &app->stats_timer, IR2HID_STATS_REFRESH_MS);
+    }
+}
+
+// --- IR Signal Handling ---
+
+// Keystrokes are only queued while a host is listening
+static bool ir2hid_hid_ready(IR2HIDApp* app) {
+    return app->usb_hid_active && furi_hal_hid_is_connected();
+}
+
+// Repeat frames of a held button send the last key again with @repeat_delay_ms set,
+// at most every @repeat_ms once the delay is over
+static void ir2hid_dispatch_repeat(IR2HIDApp* app, const InfraredMessage* msg) {
+    const IR2HIDLutSettings* settings = &app->lut.settings;
+    if(settings->repeat_delay_ms == 0) return;
+
+    furi_mutex_acquire(app->dispatch_mutex, FuriWaitForever);
+    const uint32_t now = furi_get_tick();
+    if(app->repeat_code && msg->protocol == app->last_proto && msg->address == app->last_addr &&
+       msg->command == app->last_cmd &&
+       now - app->repeat_since >= furi_ms_to_ticks(settings->repeat_delay_ms) &&
+       now - app->repeat_last >= furi_ms_to_ticks(settings->repeat_ms) && ir2hid_hid_ready(app) &&
+       ir2hid_hid_queue_tap(app->hid_queue, app->repeat_code)) {
+        app->repeat_last = now;
+    }
+    furi_mutex_release(app->dispatch_mutex);
+}
+
+// Debounce, lookup and HID dispatch. Runs on the dispatch thread, or on the main
+// loop with the split off. Returns false if the frame was filtered out, otherwise
+// row is the matched row or has IR2HID_LUT_NO_ACTION.
+static bool ir2hid_dispatch_frame(
+    IR2HIDApp* app,
+    const InfraredMessage* msg,
+    uint32_t cycles,
+    IR2HIDLatency* latency,
+    IR2HIDLutRow* row) {
+    // Protocol-level repeat frames only drive auto-repeat, no lookup or redraw
+    if(msg->repeat) {
+        ir2hid_dispatch_repeat(app, msg);
+        return false;
+    }
+
+    furi_mutex_acquire(app->dispatch_mutex, FuriWaitForever);
+
+    // Our own relayed frames come back through the receiver
+    const uint32_t now = furi_get_tick();
+    if(app->ir_tx && ir2hid_ir_tx_is_echo(app->ir_tx, msg, now)) {
+        furi_mutex_release(app->dispatch_mutex);
+        return false;
+    }
+
+    // Debounce: ignore immediate repeats of same code
+    const uint32_t debounce_ticks = furi_ms_to_ticks(app->lut.settings.debounce_ms);
+    if(msg->protocol == app->last_proto && msg->address == app->last_addr &&
+       msg->command == app->last_cmd && (now - app->last_tick) < debounce_ticks) {
+        furi_mutex_release(app->dispatch_mutex);
+        return false;
+    }
+    app->last_proto = msg->protocol;
+    app->last_addr = msg->address;
+    app->last_cmd = msg->command;
+    app->last_tick = now;
+
+    app->stats.frames++;
+
+    uint32_t index;
+    InfraredMessage relay;
+    const bool mapped = ir2hid_lookup_hid_code(app, msg, row, &index);
+    app->repeat_code = 0;
+    IR2HIDKey key;
+    if(!mapped && app->screen == IR2HIDScreenCapture && ir2hid_key_from_message(msg, &key)) {
+        ir2hid_capture_add(&app->capture, key);
+    } else if(mapped && ir2hid_lut_cooling_down(&app->lut, row, index, now)) {
+        // Burst or double press inside the row's cooldown
+        app->stats.cooldown_skips++;
+    } else if(mapped && ir2hid_lut_ir_message(&app->lut, row, &relay)) {
+        // Relayed to another device, doesn't need USB. Dropped if the queue is full,
+        // the cooldown only starts for a frame that goes out.
+        if(app->ir_tx && ir2hid_ir_tx_send(app->ir_tx, &relay)) {
+            ir2hid_lut_fire(&app->lut, row, index, now);
+        }
+    } else if(mapped && ir2hid_hid_ready(app)) {
+        const IR2HIDAction* action = ir2hid_lut_action(&app->lut, row);
+        bool queued;
+        if(action->type == IR2HIDActionTypeText) {
+            // Typed through the layout table of the LUT's @layout, straight from the
+            // resident string pool
+            const char* text = ir2hid_lut_comment(&app->lut, action->code);
+            queued =
+                text && ir2hid_hid_queue_text(app->hid_queue, app->lut.settings.layout, text);
+        } else if(action->type == IR2HIDActionTypeSystem) {
+            // Consumer report, a key held on the keyboard report stays down
+            queued = ir2hid_hid_queue_consumer(app->hid_queue, action->code);
+        } else {
+            // Cycle rows only move on when a key is actually sent
+            const uint16_t code = ir2hid_lut_press(&app->lut, row, index);
+
+            // Queue HID key (media control), sent paced to the USB polling interval
+            queued = code && ir2hid_hid_queue_tap(app->hid_queue, code);
+
+            // Rows with a cooldown are meant to fire once
+            if(queued && action->cooldown == 0) {
+                app->repeat_code = code;
+                app->repeat_since = now;
+                app->repeat_last = now;
             }
-            line_start = &buf[i + 1];
+        }
+
+        if(queued) {
+            ir2hid_lut_fire(&app->lut, row, index, now);
+            ir2hid_latency_record(latency, cycles);
         }
     }
 
-    // Store in app state
-    app->lut = lut;
-    app->lut_count = lut_index;
+    if(app->headless) app->stats.headless_frames++;
 
-    // Free the file buffer (we've parsed everything we need)
-    free(buf);
+    furi_mutex_release(app->dispatch_mutex);
+    return true;
 }
 
-// Simple linear lookup when comparing incoming IR signal 
-static bool ir2hid_lookup_hid_code(IR2HIDApp* app, const InfraredMessage* ir, uint8_t* hid_code) {
-    if(!app->lut || app->lut_count == 0) return false;
+// Dispatch on the dispatch thread, then hand the result to the main loop for the UI
+static bool ir2hid_dispatch_post(IR2HIDApp* app, const InfraredMessage* msg, uint32_t cycles) {
+    IR2HIDLutRow row;
+    if(!ir2hid_dispatch_frame(app, msg, cycles, &app->latency_thread, &row)) {
+        return false;
+    }
+    const bool mapped = row.action != IR2HID_LUT_NO_ACTION;
+
+    // Headless: no UI event at all, the main loop stays asleep
+    if(app->headless) return mapped;
+
+    // UI update only, dropped if the main loop is behind
+    AppEvent event;
+    event.type = EventTypeIRSignal;
+    event.ir_message = *msg;
+    event.ir_cycles = cycles;
+    event.ir_dispatched = true;
+    event.ir_row = row;
+    furi_message_queue_put(app->event_queue, &event, 0);
+    return mapped;
+}
+
+// Same as the worker callback for a frame decoded by the raw receiver
+static void ir2hid_dispatch_received(IR2HIDApp* app, const InfraredMessage* msg, uint32_t cycles) {
+    if(app->dispatch_split) {
+        ir2hid_dispatch_post(app, msg, cycles);
+        return;
+    }
 
-    for(size_t i = 0; i < app->lut_count; i++) {
-        const IR2HIDLutEntry* e = &app->lut[i];
-        if(e->ir.protocol == ir->protocol && e->ir.address == ir->address &&
-           e->ir.command == ir->command) {
-            if(hid_code) *hid_code = e->hid_code;
-            return true;
+    AppEvent event;
+    event.type = EventTypeIRSignal;
+    event.ir_message = *msg;
+    event.ir_cycles = cycles;
+    event.ir_dispatched = false;
+    furi_message_queue_put(app->event_queue, &event, 0);
+}
+
+// Raw receiver results. Commits are always dispatched here, whichever path frames take.
+static void ir2hid_dispatch_early(IR2HIDApp* app) {
+    IR2HIDIrRxResult result;
+    while(ir2hid_ir_rx_process(app->ir_rx, &result)) {
+        switch(result.type) {
+        case IR2HIDIrRxEventCommit:
+            // The receiver only commits codes with a LUT row, one lookup in the post.
+            // Filtered, or unmapped after a reload, the confirm handles it like any frame.
+            if(ir2hid_dispatch_post(app, &result.message, result.cycles)) {
+                app->early_pending = true;
+                app->stats.early_commits++;
+            }
+            break;
+        case IR2HIDIrRxEventConfirm:
+            if(!app->early_pending) {
+                // Commit skipped, a frame like any other
+                ir2hid_dispatch_received(app, &result.message, result.cycles);
+                break;
+            }
+            app->early_pending = false;
+            ir2hid_latency_record_span(&app->early_saved, result.commit_cycles, result.cycles);
+            break;
+        case IR2HIDIrRxEventCancel:
+            // The key already went out, all that can be done is count it
+            if(app->early_pending) {
+                app->early_pending = false;
+                app->stats.early_cancels++;
+            }
+            break;
+        case IR2HIDIrRxEventFrame:
+            ir2hid_dispatch_received(app, &result.message, result.cycles);
+            break;
         }
     }
-    return false;
 }
 
-// --- IR Worker Callback ---
+static int32_t ir2hid_dispatch_thread(void* ctx) {
+    IR2HIDApp* app = ctx;
 
-// Runs in background thread
-static void ir_worker_callback(void* context, InfraredWorkerSignal* signal) {
-    IR2HIDApp* app = (IR2HIDApp*)context;
+    while(true) {
+        const uint32_t flags = furi_thread_flags_wait(
+            IR2HID_DISPATCH_FLAG_FRAME | IR2HID_DISPATCH_FLAG_EXIT | IR2HID_DISPATCH_FLAG_TIMINGS,
+            FuriFlagWaitAny,
+            FuriWaitForever);
+        if(flags & FuriFlagError) continue;
+        if(flags & IR2HID_DISPATCH_FLAG_EXIT) break;
 
-    // 1. Decodes signal
-    const InfraredMessage* msg = infrared_worker_get_decoded_signal(signal);
-    
-    // 2. Copies signal to Queue
-    // Don't make GUI changes to avoid race conditions
-    if(msg) {
-        AppEvent event;
-        event.type = EventTypeIRSignal;
-        event.ir_message = *msg; 
-        furi_message_queue_put(app->event_queue, &event, 0);
+        if(flags & IR2HID_DISPATCH_FLAG_TIMINGS) ir2hid_dispatch_early(app);
+
+        IR2HIDIrFrame frame;
+        while(ir2hid_ir_ring_pop(&app->ir_ring, &frame)) {
+            ir2hid_dispatch_post(app, &frame.message, frame.cycles);
+        }
     }
+
+    return 0;
 }
 
-// --- GUI Rendering ---
+// Short dispatch_mutex hold, the capture screen then draws under mutex alone
+static void ir2hid_capture_snapshot(IR2HIDApp* app) {
+    IR2HIDCaptureView view = {0};
+    furi_mutex_acquire(app->dispatch_mutex, FuriWaitForever);
+    view.count = app->capture.count;
+    view.last = app->capture.last;
+    if(view.count) view.entry = app->capture.entries[view.last];
+    view.dropped = app->capture.dropped;
+    furi_mutex_release(app->dispatch_mutex);
 
-static void render_callback(Canvas* canvas, void* ctx) {
-    IR2HIDApp* app = (IR2HIDApp*)ctx;
+    furi_mutex_acquire(app->mutex, FuriWaitForever);
+    app->capture_view = view;
+    furi_mutex_release(app->mutex);
+}
 
-    canvas_clear(canvas);
-    canvas_set_font(canvas, FontPrimary);
-    
-    // Check USB HID connection status
-    bool hid_connected = app->usb_hid_active && furi_hal_hid_is_connected();
-    if(hid_connected) {
-        canvas_draw_str(canvas, 2, 10, "IR > HID [Connected]");
-    } else {
-        canvas_draw_str(canvas, 2, 10, "IR > HID");
+static void ir2hid_handle_ir_signal(IR2HIDApp* app, const AppEvent* event) {
+    IR2HIDLutRow row = event->ir_row;
+    if(!event->ir_dispatched && !ir2hid_dispatch_frame(
+                                    app,
+                                    &event->ir_message,
+                                    event->ir_cycles,
+                                    &app->latency_loop,
+                                    &row)) {
+        return;
     }
-    
-    canvas_draw_line(canvas, 0, 12, 128, 12);
-    canvas_set_font(canvas, FontSecondary);
 
+    // Headless: lookup and dispatch only, no locking or redraw
+    if(app->headless) {
+        return;
+    }
+
+    const uint32_t ui_start = DWT->CYCCNT;
+
+    // Update Display State Safely, raw values only, formatting is left to the redraw
     furi_mutex_acquire(app->mutex, FuriWaitForever);
+    app->last_signal = event->ir_message;
+    app->last_row = row;
+    app->has_signal = true;
+    furi_mutex_release(app->mutex);
 
-    if(!app->has_signal) {
-        canvas_draw_str(canvas, 10, 35, "Waiting for signal...");
-    } else {
-        canvas_draw_str(canvas, 2, 25, app->text_proto);
-        canvas_draw_str(canvas, 2, 37, app->text_addr);
-        canvas_draw_str(canvas, 2, 49, app->text_cmd);
+    // Unthrottled, a deferred redraw still draws the latest set
+    if(app->screen == IR2HIDScreenCapture) ir2hid_capture_snapshot(app);
+
+    // Trigger Redraw, throttled: the latest state is drawn once the interval is over
+    const uint32_t redraw_ticks = furi_ms_to_ticks(app->lut.settings.redraw_ms);
+    const uint32_t since_redraw = furi_get_tick() - app->redraw_tick;
+    if(!app->redraw_done || since_redraw >= redraw_ticks) {
+        ir2hid_timer_cancel(app->timers, &app->redraw_timer);
+        ir2hid_redraw(app);
+    } else if(!ir2hid_timer_is_pending(&app->redraw_timer)) {
+        ir2hid_timer_schedule(
+            app->timers,
+            &app->redraw_timer,
+            (redraw_ticks - since_redraw) * 1000 / furi_kernel_get_tick_frequency());
     }
 
+    furi_mutex_acquire(app->mutex, FuriWaitForever);
+    app->stats.ui_frames++;
+    app->stats.ui_cycles += DWT->CYCCNT - ui_start;
     furi_mutex_release(app->mutex);
 }
 
@@ -322,6 +1080,142 @@ static void input_callback(InputEvent* input_event, void* ctx) {
     furi_message_queue_put(app->event_queue, &event, 0);
 }
 
+// Formatted under the dispatch mutex, written without it so dispatch never waits on the SD card
+static bool ir2hid_capture_flush(IR2HIDApp* app) {
+    furi_mutex_acquire(app->dispatch_mutex, FuriWaitForever);
+    const size_t size = ir2hid_capture_format_size(&app->capture);
+    char* text = malloc(size);
+    const size_t len = ir2hid_capture_format(&app->capture, text, size);
+    app->capture.dirty = false;
+    furi_mutex_release(app->dispatch_mutex);
+
+    const bool ok = ir2hid_capture_save(text, len);
+    free(text);
+    if(!ok) {
+        furi_mutex_acquire(app->dispatch_mutex, FuriWaitForever);
+        app->capture.dirty = true;
+        furi_mutex_release(app->dispatch_mutex);
+    }
+    return ok;
+}
+
+static void ir2hid_set_headless(IR2HIDApp* app, bool headless) {
+    app->headless = headless;
+    notification_message(
+        app->notifications,
+        headless ? &sequence_display_backlight_off : &sequence_display_backlight_on);
+    ir2hid_stats_timer_update(app);
+    // Codes kept coming in while the display was off
+    if(!headless && app->screen == IR2HIDScreenCapture) ir2hid_capture_snapshot(app);
+    view_port_update(app->view_port);
+}
+
+// Every size that fits in RAM, each appended to bench.csv, then gated on the baseline
+static void ir2hid_bench_sweep(IR2HIDApp* app) {
+    app->bench_sweep_count = 0;
+    app->bench_baseline = IR2HIDBenchBaselineNone;
+    for(size_t i = 0; i < IR2HID_BENCH_SWEEP; i++) {
+        IR2HIDBenchReport* report = &app->bench_sweep[app->bench_sweep_count];
+        if(!ir2hid_bench_run(ir2hid_bench_sizes[i], report)) break;
+        ir2hid_bench_save(report);
+        app->bench_sweep_count++;
+    }
+
+    if(app->bench_sweep_count == 0) {
+        app->bench_state = IR2HIDBenchStateNoMemory;
+        return;
+    }
+    if(!ir2hid_bench_gate(app->bench_sweep, app->bench_sweep_count, &app->bench_gate) &&
+       app->bench_gate.baseline_missing) {
+        FURI_LOG_W(TAG, "Bench failed: no baseline");
+    } else if(app->bench_gate.regressions) {
+        FURI_LOG_W(
+            TAG,
+            "Bench regressed: %zu of %zu",
+            app->bench_gate.regressions,
+            app->bench_gate.compared);
+    }
+    app->bench_state = IR2HIDBenchStateSweepDone;
+}
+
+// Returns false when the app should exit
+static bool ir2hid_handle_input(IR2HIDApp* app, const InputEvent* input) {
+    if(input->key == InputKeyBack && input->type == InputTypeShort) {
+        return false;
+    } else if(input->key == InputKeyBack && input->type == InputTypeLong) {
+        // Exit but keep USB in HID mode so the next launch is instant
+        app->usb_hid_keep = true;
+        return false;
+    }
+
+    if(input->key == InputKeyOk && input->type == InputTypeLong) {
+        ir2hid_set_headless(app, !app->headless);
+        return true;
+    }
+
+    // Wake gesture is the only thing handled while headless
+    if(app->headless || input->type != InputTypeShort) return true;
+
+    if(input->key == InputKeyRight) {
+        app->screen = (app->screen + 1) % IR2HIDScreenCount;
+    } else if(input->key == InputKeyLeft) {
+        app->screen = (app->screen + IR2HIDScreenCount - 1) % IR2HIDScreenCount;
+    } else if(app->screen == IR2HIDScreenStats && input->key == InputKeyDown) {
+        char line[40];
+        if(ir2hid_stats_format_line(
+               app, app->stats_scroll + IR2HID_STATS_VISIBLE_LINES, line, sizeof(line))) {
+            app->stats_scroll++;
+        }
+    } else if(app->screen == IR2HIDScreenStats && input->key == InputKeyUp) {
+        if(app->stats_scroll > 0) app->stats_scroll--;
+    } else if(app->screen == IR2HIDScreenStats && input->key == InputKeyOk) {
+        // A/B switch for the jitter figures, each path keeps its own samples
+        app->dispatch_split = !app->dispatch_split;
+    } else if(app->screen == IR2HIDScreenBench && input->key == InputKeyUp) {
+        app->bench_size = (app->bench_size + 1) % (IR2HID_BENCH_SWEEP + 1);
+        app->bench_state = IR2HIDBenchStateIdle;
+    } else if(app->screen == IR2HIDScreenBench && input->key == InputKeyDown) {
+        app->bench_size = (app->bench_size + IR2HID_BENCH_SWEEP) % (IR2HID_BENCH_SWEEP + 1);
+        app->bench_state = IR2HIDBenchStateIdle;
+    } else if(
+        app->screen == IR2HIDScreenBench && input->key == InputKeyOk &&
+        app->bench_state == IR2HIDBenchStateSweepDone && app->bench_gate.baseline_missing &&
+        app->bench_baseline == IR2HIDBenchBaselineNone) {
+        // Only ever taken on request, a missing baseline never passes by itself
+        app->bench_baseline =
+            ir2hid_bench_save_baseline(app->bench_sweep, app->bench_sweep_count) ?
+                IR2HIDBenchBaselineSaved :
+                IR2HIDBenchBaselineFailed;
+    } else if(
+        app->screen == IR2HIDScreenBench && input->key == InputKeyOk &&
+        app->bench_size == IR2HID_BENCH_SWEEP) {
+        ir2hid_bench_sweep(app);
+    } else if(app->screen == IR2HIDScreenBench && input->key == InputKeyOk) {
+        // Blocks the event loop for the duration of the run, IR frames wait in the queue
+        if(ir2hid_bench_run(ir2hid_bench_sizes[app->bench_size], &app->bench_report)) {
+            app->bench_state = IR2HIDBenchStateDone;
+            app->bench_saved = ir2hid_bench_save(&app->bench_report);
+        } else {
+            app->bench_state = IR2HIDBenchStateNoMemory;
+        }
+    } else if(app->screen == IR2HIDScreenCapture && input->key == InputKeyOk) {
+        app->capture_save = ir2hid_capture_flush(app) ? IR2HIDCaptureSaveOk :
+                                                        IR2HIDCaptureSaveFailed;
+    } else if(app->screen == IR2HIDScreenCapture && input->key == InputKeyDown) {
+        furi_mutex_acquire(app->dispatch_mutex, FuriWaitForever);
+        ir2hid_capture_reset(&app->capture);
+        furi_mutex_release(app->dispatch_mutex);
+        app->capture_save = IR2HIDCaptureSaveNone;
+    } else {
+        return true;
+    }
+
+    if(app->screen == IR2HIDScreenCapture) ir2hid_capture_snapshot(app);
+    ir2hid_stats_timer_update(app);
+    view_port_update(app->view_port);
+    return true;
+}
+
 // --- Main Entry Point ---
 
 int32_t ir2hid_app(void* p) {
@@ -329,43 +1223,124 @@ int32_t ir2hid_app(void* p) {
     
     // 1. Initialization
     IR2HIDApp* app = malloc(sizeof(IR2HIDApp));
-    app->event_queue = furi_message_queue_alloc(8, sizeof(AppEvent));
     app->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    app->screen = IR2HIDScreenMain;
+    app->stats_scroll = 0;
+    app->headless = false;
+    memset(&app->stats, 0, sizeof(app->stats));
+    app->bench_size = 0;
+    app->bench_state = IR2HIDBenchStateIdle;
+    app->bench_saved = false;
+    app->bench_sweep_count = 0;
+    app->bench_baseline = IR2HIDBenchBaselineNone;
+    ir2hid_capture_reset(&app->capture);
+    app->capture_save = IR2HIDCaptureSaveNone;
+    app->capture_view = (IR2HIDCaptureView){0};
     app->has_signal = false;
-    app->lut = NULL;
-    app->lut_count = 0;
+    app->last_row.action = IR2HID_LUT_NO_ACTION;
+    app->has_status = false;
+    memset(&app->lut, 0, sizeof(app->lut));
+    for(size_t i = 0; i < IR2HID_MRU_SIZE; i++) {
+        app->mru[i].key = IR2HID_MRU_EMPTY;
+        app->mru[i].row.action = IR2HID_LUT_NO_ACTION;
+        app->mru[i].index = 0;
+    }
     app->usb_prev_if = NULL;
     app->usb_hid_active = false;
+    app->usb_hid_reused = false;
+    app->usb_hid_keep = false;
+    app->start_tick = furi_get_tick();
+    app->usb_ready = false;
+    app->usb_ready_ms = 0;
+    app->hid_queue = ir2hid_hid_queue_alloc();
+    memset(&app->hid_meter, 0, sizeof(app->hid_meter));
+    app->hid_meter_tick = 0;
+    app->hid_queued_rate = 0;
+    app->hid_sent_rate = 0;
+    app->hid_wait_ms = 0;
+    app->ir_tx = NULL;
+    app->ir_ring.head = 0;
+    app->ir_ring.tail = 0;
+    app->dispatch_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    app->dispatch_split = true;
+    ir2hid_latency_reset(&app->latency_thread);
+    ir2hid_latency_reset(&app->latency_loop);
+    app->ir_rx = NULL;
+    app->early_pending = false;
+    ir2hid_latency_reset(&app->early_saved);
+    app->timers = ir2hid_timer_wheel_alloc(ir2hid_timer_wakeup, app);
+    ir2hid_timer_init(&app->redraw_timer, ir2hid_redraw_timer_callback, app);
+    ir2hid_timer_init(&app->stats_timer, ir2hid_stats_timer_callback, app);
+    ir2hid_timer_init(&app->usb_ready_timer, ir2hid_usb_ready_timer_callback, app);
+    app->redraw_tick = 0;
+    app->redraw_done = false;
     app->last_proto = InfraredProtocolUnknown;
     app->last_addr = 0;
     app->last_cmd = 0;
     app->last_tick = 0;
+    app->repeat_code = 0;
+    app->repeat_since = 0;
+    app->repeat_last = 0;
 
-    // 2. ViewPort Setup
+    // 2. Configure USB as HID (remember previous mode), the host enumerates while the LUT loads
+    app->usb_prev_if = furi_hal_usb_get_config();
+    if(app->usb_prev_if == &usb_hid) {
+        // Left configured by a previous run, skip the host re-enumeration.
+        // The original mode is unknown by now, fall back to the default CDC.
+        app->usb_prev_if = &usb_cdc_single;
+        app->usb_hid_reused = true;
+        app->usb_hid_active = true;
+    } else {
+        furi_hal_usb_unlock();
+        if(furi_hal_usb_set_config(&usb_hid, NULL)) {
+            app->usb_hid_active = true;
+        }
+    }
+
+    // 3. Load LUT from CSV, its @ settings size the rest
+    ir2hid_load_lut(app);
+    const IR2HIDLutSettings* settings = &app->lut.settings;
+    ir2hid_hid_queue_set_min_press(app->hid_queue, settings->min_press_ms);
+    app->dispatch_split = settings->dispatch_thread;
+
+    // 4. ViewPort Setup
+    app->event_queue = furi_message_queue_alloc(settings->event_queue, sizeof(AppEvent));
     app->view_port = view_port_alloc();
     view_port_draw_callback_set(app->view_port, render_callback, app);
     view_port_input_callback_set(app->view_port, input_callback, app);
     
     app->gui = furi_record_open(RECORD_GUI);
     gui_add_view_port(app->gui, app->view_port, GuiLayerFullscreen);
-
-    // 3. Configure USB as HID (remember previous mode)
-    app->usb_prev_if = furi_hal_usb_get_config();
-    furi_hal_usb_unlock();
-    if(furi_hal_usb_set_config(&usb_hid, NULL)) {
-        app->usb_hid_active = true;
+    app->notifications = furi_record_open(RECORD_NOTIFICATION);
+
+    // 5. HID dispatch thread, above the GUI and the main loop so UI work can't delay keystrokes
+    app->dispatch_thread =
+        furi_thread_alloc_ex("IR2HIDDispatch", 2048, ir2hid_dispatch_thread, app);
+    furi_thread_set_priority(app->dispatch_thread, FuriThreadPriorityHigh);
+    furi_thread_start(app->dispatch_thread);
+
+    // 6. IR Receiver Setup, raw timings to the dispatch thread with @early_nec,on
+    if(settings->early_nec) {
+        app->ir_worker = NULL;
+        app->ir_rx = ir2hid_ir_rx_alloc(
+            furi_thread_get_id(app->dispatch_thread),
+            IR2HID_DISPATCH_FLAG_TIMINGS,
+            ir2hid_early_match,
+            app);
+        app->ir_tx = ir2hid_ir_tx_alloc(&ir2hid_ir_tx_sink_raw_rx, app->ir_rx);
+        ir2hid_ir_rx_start(app->ir_rx);
+    } else {
+        app->ir_worker = infrared_worker_alloc();
+        infrared_worker_rx_set_received_signal_callback(app->ir_worker, ir_worker_callback, app);
+        app->ir_tx = ir2hid_ir_tx_alloc(&ir2hid_ir_tx_sink_infrared, app->ir_worker);
+        infrared_worker_rx_start(app->ir_worker);
+        infrared_worker_rx_enable_blink_on_receiving(app->ir_worker, true);
     }
 
-    // 4. Load LUT from CSV
-    ir2hid_load_lut(app);
-
-    // 5. IR Worker Setup
-    app->ir_worker = infrared_worker_alloc();
-    infrared_worker_rx_set_received_signal_callback(app->ir_worker, ir_worker_callback, app);
-    infrared_worker_rx_start(app->ir_worker);
-    infrared_worker_rx_enable_blink_on_receiving(app->ir_worker, true);
+    // Time to a usable HID session, checked now and then polled from the main loop
+    if(app->usb_hid_active) ir2hid_usb_ready_timer_callback(app);
 
-    // 6. Main Loop
+    // 7. Main Loop
     AppEvent event;
     bool running = true;
     while(running) {
@@ -373,104 +1348,77 @@ int32_t ir2hid_app(void* p) {
         
         if(status == FuriStatusOk) {
             if(event.type == EventTypeKey) {
-                if(event.input.key == InputKeyBack && event.input.type == InputTypeShort) {
-                    running = false;
-                }
+                running = ir2hid_handle_input(app, &event.input);
             } 
             else if (event.type == EventTypeIRSignal) {
                 // --- HEAVY LIFTING DONE HERE (SAFE) ---
+                ir2hid_handle_ir_signal(app, &event);
+            }
 
-                // Ignore protocol-level repeat frames entirely, only first message
-                if(event.ir_message.repeat) {
-                    continue;
-                }
-
-                // Debounce: ignore immediate repeats of same code
-                const uint32_t now = furi_get_tick();
-                const uint32_t debounce_ticks = furi_ms_to_ticks(5); // cooldown
-                if(event.ir_message.protocol == app->last_proto &&
-                   event.ir_message.address == app->last_addr &&
-                   event.ir_message.command == app->last_cmd &&
-                   (now - app->last_tick) < debounce_ticks) {
-                    continue;
-                }
-                app->last_proto = event.ir_message.protocol;
-                app->last_addr = event.ir_message.address;
-                app->last_cmd = event.ir_message.command;
-                app->last_tick = now;
-
-                // 1. Validate Protocol
-                const char* name = NULL;
-                if(infrared_is_protocol_valid(event.ir_message.protocol)) {
-                    name = infrared_get_protocol_name(event.ir_message.protocol);
-                }
-                if(!name) name = "Unknown";
-
-                // 2. Format Strings into temporary buffers
-                char temp_proto[32];
-                char temp_addr[32];
-                char temp_cmd[32];
-
-                snprintf(temp_proto, sizeof(temp_proto), "Proto: %s", name);
-                snprintf(temp_addr, sizeof(temp_addr),  "Addr: 0x%04lX", event.ir_message.address);
-                uint8_t hid_code = 0;
-                if(ir2hid_lookup_hid_code(app, &event.ir_message, &hid_code)) {
-                    // Send HID consumer key (media control)
-                    if(app->usb_hid_active && furi_hal_hid_is_connected()) {
-                        furi_hal_hid_kb_press(hid_code);
-                        furi_hal_hid_kb_release(hid_code);
-                    }
-
-                    snprintf(
-                        temp_cmd,
-                        sizeof(temp_cmd),
-                        "Cmd:0x%04lX HID:0x%02X",
-                        event.ir_message.command,
-                        hid_code);
-                } else {
-                    snprintf(
-                        temp_cmd,
-                        sizeof(temp_cmd),
-                        "Cmd:0x%04lX (no map)",
-                        event.ir_message.command);
-                }
-
-                // 3. Update Display State Safely
-                furi_mutex_acquire(app->mutex, FuriWaitForever);
-                
-                // Copy strings to app state
-                strlcpy(app->text_proto, temp_proto, sizeof(app->text_proto));
-                strlcpy(app->text_addr, temp_addr, sizeof(app->text_addr));
-                strlcpy(app->text_cmd, temp_cmd, sizeof(app->text_cmd));
-                app->has_signal = true;
-                
-                furi_mutex_release(app->mutex);
-
-                // 4. Trigger Redraw
-                view_port_update(app->view_port);
+            // After any event, EventTypeTick only wakes the loop
+            if(running && app->tick_pending) {
+                app->tick_pending = false;
+                ir2hid_timer_wheel_advance(app->timers, furi_get_tick());
             }
         }
     }
 
-    // 7. Cleanup
-    infrared_worker_rx_stop(app->ir_worker);
-    infrared_worker_free(app->ir_worker);
+    // 8. Cleanup
+    // The transmit thread restarts reception after each frame, it has to go first.
+    // Detached under the dispatch mutex so the dispatch thread stops queueing.
+    furi_mutex_acquire(app->dispatch_mutex, FuriWaitForever);
+    IR2HIDIrTx* ir_tx = app->ir_tx;
+    app->ir_tx = NULL;
+    furi_mutex_release(app->dispatch_mutex);
+    ir2hid_ir_tx_free(ir_tx);
+
+    if(app->ir_rx) {
+        ir2hid_ir_rx_stop(app->ir_rx);
+    } else {
+        infrared_worker_rx_stop(app->ir_worker);
+        infrared_worker_free(app->ir_worker);
+    }
+
+    // No producer left, stop the dispatch thread before the LUT and HID queue go away
+    furi_thread_flags_set(furi_thread_get_id(app->dispatch_thread), IR2HID_DISPATCH_FLAG_EXIT);
+    furi_thread_join(app->dispatch_thread);
+    furi_thread_free(app->dispatch_thread);
+    if(app->ir_rx) ir2hid_ir_rx_free(app->ir_rx);
+
+    // Stops the FuriTimer, pending timers are just dropped
+    ir2hid_timer_wheel_free(app->timers);
+
+    // Give the backlight back to the system if we left it off
+    if(app->headless) {
+        notification_message(app->notifications, &sequence_display_backlight_on);
+    }
+    furi_record_close(RECORD_NOTIFICATION);
 
     gui_remove_view_port(app->gui, app->view_port);
     view_port_free(app->view_port);
     furi_record_close(RECORD_GUI);
 
-    if(app->lut) {
-        free(app->lut);
-    }
+    // Codes captured since the last save aren't lost by leaving
+    furi_mutex_acquire(app->dispatch_mutex, FuriWaitForever);
+    const bool capture_dirty = app->capture.dirty;
+    furi_mutex_release(app->dispatch_mutex);
+    if(capture_dirty) ir2hid_capture_flush(app);
+
+    // Cycle positions are only written once, here
+    ir2hid_lut_save_state(&app->lut);
+    ir2hid_lut_free(&app->lut);
 
-    if(app->usb_hid_active) {
+    // Flushes any held key before USB is switched back
+    ir2hid_hid_queue_free(app->hid_queue);
+
+    if(app->usb_hid_active && !app->usb_hid_keep) {
         furi_hal_usb_set_config(app->usb_prev_if, NULL);
     }
 
+    furi_mutex_free(app->dispatch_mutex);
     furi_mutex_free(app->mutex);
     furi_message_queue_free(app->event_queue);
     free(app);
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,432 @@
+#include "ir2hid_bench.h"
+#include "ir2hid_dispatch.h"
+#include "ir2hid_hid.h"
+#include "ir2hid_lut.h"
+#include "ir2hid_timer_wheel.h"
+
+#include <furi_hal.h>
+#include <stdlib.h>
+#include <storage/storage.h>
+
+#define TAG "IR2HID"
+
+// Longest generated row: "NECext,0xFFFF,0xFFFF,0xFF,key 65535,hid 255\n"
+#define IR2HID_BENCH_ROW_MAX 48
+#define IR2HID_BENCH_LOOKUPS 10000
+#define IR2HID_BENCH_FORMATS 1000
+#define IR2HID_BENCH_DISPATCHES 1000
+#define IR2HID_BENCH_LOOPS 1000
+#define IR2HID_BENCH_LOOP_TIMER_MS 1000 // never expires during the run
+#define IR2HID_BENCH_HEX_PARSES 10000
+#define IR2HID_BENCH_SPLIT_FIELDS 8
+
+static const char* const ir2hid_bench_op_names[IR2HIDBenchOpCount] = {
+    [IR2HIDBenchOpParse] = "parse",
+    [IR2HIDBenchOpBuild] = "build",
+    [IR2HIDBenchOpLookupHit] = "hit",
+    [IR2HIDBenchOpLookupMiss] = "miss",
+    [IR2HIDBenchOpFormat] = "format",
+    [IR2HIDBenchOpDispatch] = "hid",
+    [IR2HIDBenchOpLoop] = "loop",
+    [IR2HIDBenchOpHex] = "hex",
+    [IR2HIDBenchOpSplit] = "split",
+};
+
+const char* ir2hid_bench_op_name(IR2HIDBenchOp op) {
+    return ir2hid_bench_op_names[op];
+}
+
+uint32_t ir2hid_bench_ns_per_op(const IR2HIDBenchResult* result) {
+    if(result->ops == 0) return 0;
+    return (uint32_t)(result->cycles * 1000 / furi_hal_cortex_instructions_per_microsecond() /
+                      result->ops);
+}
+
+// Synthetic LUT text with unique keys in a scrambled order, so sorting has real work
+// to do. Actions and comments repeat like they do in a real LUT.
+static size_t ir2hid_bench_generate_csv(char* buf, size_t size, size_t rows) {
+    size_t len = 0;
+    len += snprintf(buf, size, "ir_protocol,ir_address,ir_command,hid_command\n");
+
+    for(size_t i = 0; i < rows && len < size; i++) {
+        const uint32_t n = (i * 7919) % rows; // 7919 is prime, visits every n once
+        len += snprintf(
+            &buf[len],
+            size - len,
+            "NECext,0x%04lX,0x%04lX,0x%02X,key %u,hid %u\n",
+            0x1000 + (n >> 8),
+            (n & 0xFF) * 0x0101,
+            0x04 + (unsigned)(n % 40),
+            (unsigned)n,
+            (unsigned)(n % 40));
+    }
+    return len;
+}
+
+static void ir2hid_bench_lookups(
+    const IR2HIDLut* lut,
+    bool hit,
+    IR2HIDBenchResult* result) {
+    uint32_t seed = 1;
+    size_t found = 0;
+    size_t index;
+
+    const uint32_t start = DWT->CYCCNT;
+    for(uint32_t i = 0; i < IR2HID_BENCH_LOOKUPS; i++) {
+        seed = seed * 1664525 + 1013904223; // LCG
+        IR2HIDKey key = lut->keys[seed % lut->count];
+        // Generated commands have equal high and low bytes, this one never exists
+        if(!hit) key ^= 0x100;
+        found += ir2hid_lut_find(lut, key, &index);
+    }
+    result->cycles = DWT->CYCCNT - start;
+    result->ops = IR2HID_BENCH_LOOKUPS;
+
+    furi_check(found == (hit ? IR2HID_BENCH_LOOKUPS : 0));
+}
+
+static void ir2hid_bench_format(const IR2HIDLut* lut, IR2HIDBenchResult* result) {
+    IR2HIDSignalText text;
+    InfraredMessage msg = {.protocol = InfraredProtocolNECext, .repeat = false};
+
+    const uint32_t start = DWT->CYCCNT;
+    for(uint32_t i = 0; i < IR2HID_BENCH_FORMATS; i++) {
+        const size_t index = i % lut->count;
+        msg.address = ir2hid_key_address(lut->keys[index]);
+        msg.command = ir2hid_key_command(lut->keys[index]);
+        ir2hid_lut_format_signal(lut, &msg, &lut->rows[index], &text);
+    }
+    result->cycles = DWT->CYCCNT - start;
+    result->ops = IR2HID_BENCH_FORMATS;
+}
+
+static void ir2hid_bench_dispatch(const IR2HIDLut* lut, IR2HIDBenchResult* result) {
+    IR2HIDHidQueue* queue = ir2hid_hid_queue_alloc_manual(&ir2hid_hid_sink_null);
+    uint32_t now = 0;
+
+    const uint32_t start = DWT->CYCCNT;
+    for(uint32_t i = 0; i < IR2HID_BENCH_DISPATCHES; i++) {
+        ir2hid_hid_queue_tap(queue, ir2hid_lut_row_action(lut, i % lut->count)->code);
+        // Press, then release once the minimum press time has passed
+        while(ir2hid_hid_queue_poll(queue, now)) {
+            now += IR2HID_HID_MIN_PRESS_MS;
+        }
+    }
+    result->cycles = DWT->CYCCNT - start;
+    result->ops = IR2HID_BENCH_DISPATCHES;
+
+    ir2hid_hid_queue_free(queue);
+}
+
+static void ir2hid_bench_loop_wakeup(void* context) {
+    UNUSED(context);
+}
+
+static void ir2hid_bench_loop_expired(void* context) {
+    UNUSED(context);
+}
+
+// What the event loop does for one frame outside the lookup: the IR ring to the
+// dispatch thread, an event of the same size through a message queue to the main
+// loop and the repeat timer rescheduled. All on this thread, no context switches.
+static void ir2hid_bench_loop(IR2HIDBenchResult* result) {
+    IR2HIDIrRing* ring = malloc(sizeof(IR2HIDIrRing));
+    memset(ring, 0, sizeof(IR2HIDIrRing));
+    FuriMessageQueue* queue = furi_message_queue_alloc(1, sizeof(IR2HIDIrFrame));
+    IR2HIDTimerWheel* wheel = ir2hid_timer_wheel_alloc(ir2hid_bench_loop_wakeup, NULL);
+    IR2HIDTimer timer;
+    ir2hid_timer_init(&timer, ir2hid_bench_loop_expired, NULL);
+
+    IR2HIDIrFrame frame = {
+        .message = {.protocol = InfraredProtocolNECext, .address = 0x1000, .command = 0x0101},
+    };
+    size_t passed = 0;
+
+    const uint32_t start = DWT->CYCCNT;
+    for(uint32_t i = 0; i < IR2HID_BENCH_LOOPS; i++) {
+        frame.cycles = i;
+        passed += ir2hid_ir_ring_push(ring, &frame) && ir2hid_ir_ring_pop(ring, &frame) &&
+                  furi_message_queue_put(queue, &frame, 0) == FuriStatusOk &&
+                  furi_message_queue_get(queue, &frame, 0) == FuriStatusOk;
+        ir2hid_timer_schedule(wheel, &timer, IR2HID_BENCH_LOOP_TIMER_MS);
+    }
+    result->cycles = DWT->CYCCNT - start;
+    result->ops = IR2HID_BENCH_LOOPS;
+
+    ir2hid_timer_cancel(wheel, &timer);
+    ir2hid_timer_wheel_free(wheel);
+    furi_message_queue_free(queue);
+    free(ring);
+
+    furi_check(passed == IR2HID_BENCH_LOOPS);
+}
+
+// Hex columns as they appear in lut.csv, with and without prefix, short and full width
+static const char* const ir2hid_bench_hex_fields[] = {
+    "0x1000",
+    "0x0101",
+    "0xFF",
+    "0x04",
+    "0X12345678",
+    "DEADBEEF",
+    "0x00EF",
+    "7",
+};
+
+static const uint32_t ir2hid_bench_hex_values[COUNT_OF(ir2hid_bench_hex_fields)] = {
+    0x1000,
+    0x0101,
+    0xFF,
+    0x04,
+    0x12345678,
+    0xDEADBEEF,
+    0xEF,
+    0x7,
+};
+
+static void ir2hid_bench_hex(IR2HIDBenchResult* result) {
+    IR2HIDCsvField fields[COUNT_OF(ir2hid_bench_hex_fields)];
+    for(size_t i = 0; i < COUNT_OF(fields); i++) {
+        fields[i].start = ir2hid_bench_hex_fields[i];
+        fields[i].len = strlen(ir2hid_bench_hex_fields[i]);
+    }
+    size_t matched = 0;
+    uint32_t value;
+
+    const uint32_t start = DWT->CYCCNT;
+    for(uint32_t i = 0; i < IR2HID_BENCH_HEX_PARSES; i++) {
+        const size_t n = i % COUNT_OF(fields);
+        matched += ir2hid_parse_hex_field(&fields[n], &value) &&
+                   value == ir2hid_bench_hex_values[n];
+    }
+    result->cycles = DWT->CYCCNT - start;
+    result->ops = IR2HID_BENCH_HEX_PARSES;
+
+    furi_check(matched == IR2HID_BENCH_HEX_PARSES);
+}
+
+// csv holds the generated text with every newline already turned into a NUL. Each
+// line's end is found from its last field, so only the tokenizer is timed.
+static void ir2hid_bench_split(char* csv, size_t rows, IR2HIDBenchResult* result) {
+    IR2HIDCsvField fields[IR2HID_BENCH_SPLIT_FIELDS];
+    char* line = csv + strlen(csv) + 1; // past the header
+    size_t split = 0;
+
+    const uint32_t start = DWT->CYCCNT;
+    for(size_t i = 0; i < rows; i++) {
+        const size_t count = ir2hid_csv_split(line, fields, IR2HID_BENCH_SPLIT_FIELDS);
+        split += count == 6;
+        line = (char*)fields[count - 1].start + fields[count - 1].len + 1;
+    }
+    result->cycles = DWT->CYCCNT - start;
+    result->ops = rows;
+
+    furi_check(split == rows);
+}
+
+bool ir2hid_bench_run(size_t rows, IR2HIDBenchReport* report) {
+    memset(report, 0, sizeof(IR2HIDBenchReport));
+    report->rows = rows;
+
+    // Text, the LUT arena and the parse-time hash tables all at once
+    const size_t csv_size = (rows + 1) * IR2HID_BENCH_ROW_MAX + 1;
+    const size_t needed = csv_size * 2 + rows * 64;
+    if(rows == 0 || needed > memmgr_get_free_heap()) return false;
+
+    char* csv = malloc(csv_size);
+    if(!csv) return false;
+    size_t len = ir2hid_bench_generate_csv(csv, csv_size, rows);
+
+    IR2HIDLut lut;
+    const size_t heap_before = memmgr_get_free_heap();
+    const bool parsed = ir2hid_lut_parse(&lut, csv, len, NULL, NULL);
+    report->heap_bytes = heap_before - memmgr_get_free_heap();
+    if(!parsed) {
+        free(csv);
+        return false;
+    }
+
+    // The parse split the text in place, the tokenizer gets a fresh copy
+    ir2hid_bench_generate_csv(csv, csv_size, rows);
+    for(char* p = csv; (p = strchr(p, '\n')) != NULL;) {
+        *p++ = '\0';
+    }
+    ir2hid_bench_split(csv, rows, &report->results[IR2HIDBenchOpSplit]);
+    free(csv);
+
+    report->results[IR2HIDBenchOpParse].cycles = lut.load_cycles - lut.build_cycles;
+    report->results[IR2HIDBenchOpParse].ops = rows;
+    report->results[IR2HIDBenchOpBuild].cycles = lut.build_cycles;
+    report->results[IR2HIDBenchOpBuild].ops = rows;
+
+    ir2hid_bench_lookups(&lut, true, &report->results[IR2HIDBenchOpLookupHit]);
+    ir2hid_bench_lookups(&lut, false, &report->results[IR2HIDBenchOpLookupMiss]);
+    ir2hid_bench_format(&lut, &report->results[IR2HIDBenchOpFormat]);
+    ir2hid_bench_dispatch(&lut, &report->results[IR2HIDBenchOpDispatch]);
+    ir2hid_bench_loop(&report->results[IR2HIDBenchOpLoop]);
+    ir2hid_bench_hex(&report->results[IR2HIDBenchOpHex]);
+
+    ir2hid_lut_free(&lut);
+    return true;
+}
+
+static bool ir2hid_bench_write(
+    File* file,
+    const IR2HIDBenchReport* reports,
+    size_t count,
+    bool header) {
+    char line[96];
+    int len;
+    bool ok = true;
+
+    if(header) {
+        len = snprintf(line, sizeof(line), "rows,op,ops,cycles,ns_per_op,cpu_mhz,heap_bytes\n");
+        ok &= storage_file_write(file, line, len) == (size_t)len;
+    }
+    for(size_t i = 0; i < count; i++) {
+        const IR2HIDBenchReport* report = &reports[i];
+        for(size_t op = 0; op < IR2HIDBenchOpCount; op++) {
+            const IR2HIDBenchResult* result = &report->results[op];
+            len = snprintf(
+                line,
+                sizeof(line),
+                "%zu,%s,%lu,%lu,%lu,%lu,%lu\n",
+                report->rows,
+                ir2hid_bench_op_name(op),
+                result->ops,
+                (uint32_t)result->cycles,
+                ir2hid_bench_ns_per_op(result),
+                furi_hal_cortex_instructions_per_microsecond(),
+                report->heap_bytes);
+            ok &= storage_file_write(file, line, len) == (size_t)len;
+        }
+    }
+    return ok;
+}
+
+bool ir2hid_bench_save(const IR2HIDBenchReport* report) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool ok = storage_file_open(file, IR2HID_BENCH_PATH, FSAM_WRITE, FSOM_OPEN_APPEND);
+
+    if(ok) {
+        ok = ir2hid_bench_write(file, report, 1, storage_file_size(file) == 0);
+        storage_file_close(file);
+    }
+
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return ok;
+}
+
+// --- Regression Gate ---
+
+// Count one figure against its baseline
+static void ir2hid_bench_gate_check(
+    IR2HIDBenchGate* gate,
+    const char* name,
+    size_t rows,
+    uint32_t value,
+    uint32_t baseline) {
+    if(baseline == 0) return;
+
+    const uint32_t pct = (uint64_t)value * 100 / baseline;
+    gate->compared++;
+    if(pct > 100 + IR2HID_BENCH_REGRESSION_PCT) {
+        gate->regressions++;
+        FURI_LOG_W(TAG, "Bench %zu rows %s: %lu vs %lu baseline", rows, name, value, baseline);
+    }
+    if(!gate->worst_name || pct > gate->worst_pct) {
+        gate->worst_name = name;
+        gate->worst_rows = rows;
+        gate->worst_pct = pct;
+    }
+}
+
+// One baseline line: rows,op,ops,cycles,ns_per_op,cpu_mhz,heap_bytes
+static void ir2hid_bench_gate_line(
+    IR2HIDBenchGate* gate,
+    char* line,
+    const IR2HIDBenchReport* reports,
+    size_t count) {
+    char* fields[7];
+    size_t field_count = 0;
+    for(char* p = line; field_count < COUNT_OF(fields); field_count++) {
+        fields[field_count] = p;
+        p = strchr(p, ',');
+        if(!p) {
+            field_count++;
+            break;
+        }
+        *p++ = '\0';
+    }
+    if(field_count < COUNT_OF(fields)) return;
+
+    const size_t rows = strtoul(fields[0], NULL, 10);
+    for(size_t i = 0; i < count; i++) {
+        if(reports[i].rows != rows) continue;
+        for(size_t op = 0; op < IR2HIDBenchOpCount; op++) {
+            if(strcmp(fields[1], ir2hid_bench_op_name(op)) != 0) continue;
+            ir2hid_bench_gate_check(
+                gate,
+                ir2hid_bench_op_name(op),
+                rows,
+                ir2hid_bench_ns_per_op(&reports[i].results[op]),
+                strtoul(fields[4], NULL, 10));
+            // Repeated on every op's line, checked once
+            if(op == 0) {
+                ir2hid_bench_gate_check(
+                    gate, "heap", rows, reports[i].heap_bytes, strtoul(fields[6], NULL, 10));
+            }
+        }
+    }
+}
+
+bool ir2hid_bench_gate(const IR2HIDBenchReport* reports, size_t count, IR2HIDBenchGate* gate) {
+    memset(gate, 0, sizeof(IR2HIDBenchGate));
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+
+    gate->baseline_missing =
+        !storage_file_open(file, IR2HID_BENCH_BASELINE_PATH, FSAM_READ, FSOM_OPEN_EXISTING);
+    if(!gate->baseline_missing) {
+        // Small file, read at once and split in place like lut.csv
+        const size_t size = MIN(storage_file_size(file), IR2HID_BENCH_BASELINE_MAX_SIZE);
+        char* buf = malloc(size + 1);
+        const size_t len = buf ? storage_file_read(file, buf, size) : 0;
+        storage_file_close(file);
+
+        if(buf) {
+            buf[len] = '\0';
+            char* line = buf;
+            while(line && *line) {
+                char* next = strchr(line, '\n');
+                if(next) *next++ = '\0';
+                ir2hid_bench_gate_line(gate, line, reports, count);
+                line = next;
+            }
+            free(buf);
+        }
+    }
+
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return !gate->baseline_missing && gate->regressions == 0;
+}
+
+bool ir2hid_bench_save_baseline(const IR2HIDBenchReport* reports, size_t count) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool ok =
+        storage_file_open(file, IR2HID_BENCH_BASELINE_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+
+    if(ok) {
+        ok = ir2hid_bench_write(file, reports, count, true);
+        storage_file_close(file);
+    }
+
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return ok;
+}
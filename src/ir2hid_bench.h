@@ -0,0 +1,74 @@
+#pragma once
+
+#include <furi.h>
+
+// --- Self-Benchmark ---
+//
+// Times the real LUT and dispatch code on a synthetic LUT generated in RAM,
+// using the DWT cycle counter.
+
+#define IR2HID_BENCH_PATH EXT_PATH("apps_data/ir2hid/bench.csv")
+// Results a sweep over every size is checked against, same columns as bench.csv.
+// A sweep without one fails, it is only written on request (OK after that sweep).
+#define IR2HID_BENCH_BASELINE_PATH EXT_PATH("apps_data/ir2hid/bench_baseline.csv")
+
+// A result regresses when it's more than this much above its baseline
+#define IR2HID_BENCH_REGRESSION_PCT 10
+
+// Largest baseline file read back
+#define IR2HID_BENCH_BASELINE_MAX_SIZE 8192
+
+typedef enum {
+    IR2HIDBenchOpParse, // per row, CSV text to records
+    IR2HIDBenchOpBuild, // per row, sort, dedup and final layout
+    IR2HIDBenchOpLookupHit,
+    IR2HIDBenchOpLookupMiss,
+    IR2HIDBenchOpFormat, // signal text as shown on screen
+    IR2HIDBenchOpDispatch, // queue + press + release to the null sink
+    IR2HIDBenchOpLoop, // per frame, IR ring, event queue and repeat timer hand-offs
+    IR2HIDBenchOpHex, // one hex column, SWAR decode
+    IR2HIDBenchOpSplit, // per row, one line into its columns
+    IR2HIDBenchOpCount,
+} IR2HIDBenchOp;
+
+typedef struct {
+    uint32_t ops;
+    uint64_t cycles;
+} IR2HIDBenchResult;
+
+typedef struct {
+    size_t rows;
+    IR2HIDBenchResult results[IR2HIDBenchOpCount];
+    // Heap held by the parsed LUT. The device heap has no allocation counter, this
+    // stands in for allocation counts.
+    uint32_t heap_bytes;
+} IR2HIDBenchReport;
+
+// Outcome of comparing a sweep with the baseline
+typedef struct {
+    bool baseline_missing; // nothing to compare with, the gate fails
+    size_t compared; // ns/op and heap figures that had a baseline
+    size_t regressions;
+    // Furthest above its baseline, in percent of it. worst_name is NULL if nothing was compared.
+    const char* worst_name;
+    size_t worst_rows;
+    uint32_t worst_pct;
+} IR2HIDBenchGate;
+
+// Run every benchmark on a LUT of `rows` rows. Returns false if there isn't enough RAM.
+bool ir2hid_bench_run(size_t rows, IR2HIDBenchReport* report);
+
+// Append the report to IR2HID_BENCH_PATH
+bool ir2hid_bench_save(const IR2HIDBenchReport* report);
+
+// Compare reports with IR2HID_BENCH_BASELINE_PATH. Returns false if any result
+// regressed or there is no baseline.
+bool ir2hid_bench_gate(const IR2HIDBenchReport* reports, size_t count, IR2HIDBenchGate* gate);
+
+// Write reports to IR2HID_BENCH_BASELINE_PATH, replacing the previous baseline
+bool ir2hid_bench_save_baseline(const IR2HIDBenchReport* reports, size_t count);
+
+const char* ir2hid_bench_op_name(IR2HIDBenchOp op);
+
+// Nanoseconds per operation at the current core clock
+uint32_t ir2hid_bench_ns_per_op(const IR2HIDBenchResult* result);
@@ -0,0 +1,98 @@
+#include "ir2hid_capture.h"
+
+#include <storage/storage.h>
+#include <string.h>
+
+#define IR2HID_CAPTURE_HEADER \
+    "ir_protocol,ir_address,ir_command,hid_command,ir_key_comment,hid_key_comment\n"
+
+void ir2hid_capture_reset(IR2HIDCapture* capture) {
+    memset(capture->slots, IR2HID_CAPTURE_EMPTY, sizeof(capture->slots));
+    capture->count = 0;
+    capture->last = 0;
+    capture->dropped = 0;
+    capture->dirty = false;
+}
+
+bool ir2hid_capture_add(IR2HIDCapture* capture, IR2HIDKey key) {
+    // Buttons of one remote only differ in the command, mix it into the high bits
+    const uint32_t hash = ((uint32_t)key ^ (uint32_t)(key >> 32)) * 2654435761UL;
+    size_t slot = (hash >> 16) & (IR2HID_CAPTURE_SLOTS - 1);
+
+    while(capture->slots[slot] != IR2HID_CAPTURE_EMPTY) {
+        IR2HIDCaptureEntry* entry = &capture->entries[capture->slots[slot]];
+        if(entry->key == key) {
+            entry->hits++;
+            capture->last = capture->slots[slot];
+            capture->dirty = true;
+            return true;
+        }
+        slot = (slot + 1) & (IR2HID_CAPTURE_SLOTS - 1);
+    }
+
+    if(capture->count == IR2HID_CAPTURE_MAX) {
+        capture->dropped++;
+        return false;
+    }
+
+    capture->entries[capture->count] = (IR2HIDCaptureEntry){.key = key, .hits = 1};
+    capture->slots[slot] = (uint8_t)capture->count;
+    capture->last = capture->count++;
+    capture->dirty = true;
+    return true;
+}
+
+// Hex digits the protocol actually uses, so rows read like the remote's codes
+static int ir2hid_capture_digits(uint8_t bits) {
+    return bits ? (bits + 3) / 4 : 4;
+}
+
+static int ir2hid_capture_format_entry(
+    const IR2HIDCaptureEntry* entry,
+    size_t number,
+    char* buf,
+    size_t buf_size) {
+    const InfraredProtocol proto = ir2hid_key_protocol(entry->key);
+    return snprintf(
+        buf,
+        buf_size,
+        "%s,0x%0*lX,0x%0*lX,0x00,button %zu x%lu,\n",
+        infrared_get_protocol_name(proto),
+        ir2hid_capture_digits(infrared_get_protocol_address_length(proto)),
+        ir2hid_key_address(entry->key),
+        ir2hid_capture_digits(infrared_get_protocol_command_length(proto)),
+        ir2hid_key_command(entry->key),
+        number,
+        entry->hits);
+}
+
+size_t ir2hid_capture_format_size(const IR2HIDCapture* capture) {
+    return sizeof(IR2HID_CAPTURE_HEADER) + capture->count * IR2HID_CAPTURE_LINE_MAX;
+}
+
+size_t ir2hid_capture_format(const IR2HIDCapture* capture, char* buf, size_t buf_size) {
+    size_t len = strlcpy(buf, IR2HID_CAPTURE_HEADER, buf_size);
+    for(size_t i = 0; i < capture->count && len < buf_size; i++) {
+        const int written =
+            ir2hid_capture_format_entry(&capture->entries[i], i + 1, buf + len, buf_size - len);
+        if(written < 0) break;
+        len += MIN((size_t)written, buf_size - len - 1);
+    }
+    return MIN(len, buf_size - 1);
+}
+
+bool ir2hid_capture_save(const char* text, size_t len) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+
+    // One write for the whole table
+    bool ok = storage_file_open(file, IR2HID_CAPTURE_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+    if(ok) {
+        ok = storage_file_write(file, text, len) == len;
+        storage_file_close(file);
+    }
+
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return ok;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <furi.h>
+
+#include "ir2hid_lut.h"
+
+// --- Capture ---
+//
+// Every distinct unmapped code received while the capture screen is open, with
+// how often it was seen. Nothing touches the SD card until the set is saved as
+// a lut.csv skeleton in a single write.
+
+#define IR2HID_CAPTURE_PATH EXT_PATH("apps_data/ir2hid/capture.csv")
+
+#define IR2HID_CAPTURE_MAX 96 // distinct codes, two remotes' worth
+#define IR2HID_CAPTURE_SLOTS 128 // power of 2, open addressing over entry indexes
+#define IR2HID_CAPTURE_EMPTY 0xFF
+
+// Longest skeleton row: NEC42ext,0x12345678,0x123456,0x00,button 96 x4294967295,
+#define IR2HID_CAPTURE_LINE_MAX 64
+
+typedef struct {
+    IR2HIDKey key;
+    uint32_t hits;
+} IR2HIDCaptureEntry;
+
+typedef struct {
+    IR2HIDCaptureEntry entries[IR2HID_CAPTURE_MAX]; // in order of first capture
+    uint8_t slots[IR2HID_CAPTURE_SLOTS];
+    size_t count;
+    size_t last; // entry of the latest hit, valid if count > 0
+    uint32_t dropped; // new codes that didn't fit
+    bool dirty; // captured since the last save
+} IR2HIDCapture;
+
+void ir2hid_capture_reset(IR2HIDCapture* capture);
+
+// Count a hit on key, false if it's new and the set is full
+bool ir2hid_capture_add(IR2HIDCapture* capture, IR2HIDKey key);
+
+// The whole set as lut.csv text with its header, hid_command left at 0x00 to be
+// filled in. Returns the length, at most IR2HID_CAPTURE_LINE_MAX per entry plus a header.
+size_t ir2hid_capture_format(const IR2HIDCapture* capture, char* buf, size_t buf_size);
+
+// Buffer size ir2hid_capture_format needs for the current set
+size_t ir2hid_capture_format_size(const IR2HIDCapture* capture);
+
+// Write formatted text to IR2HID_CAPTURE_PATH, replacing the previous capture
+bool ir2hid_capture_save(const char* text, size_t len);
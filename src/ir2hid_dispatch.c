@@ -0,0 +1,64 @@
+#include "ir2hid_dispatch.h"
+
+#include <furi_hal.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- IR Frame Ring ---
+
+bool ir2hid_ir_ring_push(IR2HIDIrRing* ring, const IR2HIDIrFrame* frame) {
+    if((ring->head - ring->tail) >= IR2HID_IR_RING_SIZE) return false;
+
+    ring->frames[ring->head % IR2HID_IR_RING_SIZE] = *frame;
+    // Publish the frame only once it's fully written
+    __DMB();
+    ring->head++;
+    return true;
+}
+
+bool ir2hid_ir_ring_pop(IR2HIDIrRing* ring, IR2HIDIrFrame* frame) {
+    if(ring->tail == ring->head) return false;
+
+    __DMB();
+    *frame = ring->frames[ring->tail % IR2HID_IR_RING_SIZE];
+    __DMB();
+    ring->tail++;
+    return true;
+}
+
+// --- Dispatch Latency ---
+
+void ir2hid_latency_reset(IR2HIDLatency* latency) {
+    memset(latency, 0, sizeof(*latency));
+}
+
+void ir2hid_latency_record(IR2HIDLatency* latency, uint32_t start_cycles) {
+    ir2hid_latency_record_span(latency, start_cycles, DWT->CYCCNT);
+}
+
+void ir2hid_latency_record_span(IR2HIDLatency* latency, uint32_t start_cycles, uint32_t end_cycles) {
+    const uint32_t us =
+        (end_cycles - start_cycles) / furi_hal_cortex_instructions_per_microsecond();
+    latency->samples[latency->count % IR2HID_LATENCY_SAMPLES] = us;
+    latency->count++;
+}
+
+static int ir2hid_latency_compare(const void* a, const void* b) {
+    const uint32_t x = *(const uint32_t*)a;
+    const uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+bool ir2hid_latency_percentiles(const IR2HIDLatency* latency, uint32_t* p50, uint32_t* p99) {
+    const size_t count = latency->count < IR2HID_LATENCY_SAMPLES ? latency->count :
+                                                                   IR2HID_LATENCY_SAMPLES;
+    if(count == 0) return false;
+
+    uint32_t sorted[IR2HID_LATENCY_SAMPLES];
+    memcpy(sorted, latency->samples, count * sizeof(uint32_t));
+    qsort(sorted, count, sizeof(uint32_t), ir2hid_latency_compare);
+
+    *p50 = sorted[(count - 1) * 50 / 100];
+    *p99 = sorted[(count - 1) * 99 / 100];
+    return true;
+}
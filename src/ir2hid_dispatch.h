@@ -0,0 +1,50 @@
+#pragma once
+
+#include <furi.h>
+#include <infrared.h>
+
+// --- IR Frame Ring ---
+//
+// Lock-free single producer / single consumer ring carrying decoded IR frames
+// from the IR worker thread to the HID dispatch thread.
+
+#define IR2HID_IR_RING_SIZE 16 // power of 2
+
+typedef struct {
+    InfraredMessage message;
+    uint32_t cycles; // DWT->CYCCNT when the worker decoded it
+} IR2HIDIrFrame;
+
+typedef struct {
+    IR2HIDIrFrame frames[IR2HID_IR_RING_SIZE];
+    volatile uint32_t head; // written by producer
+    volatile uint32_t tail; // written by consumer
+} IR2HIDIrRing;
+
+// Returns false if the ring is full, the frame is dropped
+bool ir2hid_ir_ring_push(IR2HIDIrRing* ring, const IR2HIDIrFrame* frame);
+
+bool ir2hid_ir_ring_pop(IR2HIDIrRing* ring, IR2HIDIrFrame* frame);
+
+// --- Dispatch Latency ---
+//
+// IR decode to HID dispatch latency of the most recent keystrokes, for the
+// p50 / p99 jitter figures on the stats screen.
+
+#define IR2HID_LATENCY_SAMPLES 64 // sorted on the stack when the stats are drawn
+
+typedef struct {
+    uint32_t samples[IR2HID_LATENCY_SAMPLES]; // us, ring
+    uint32_t count; // samples ever recorded
+} IR2HIDLatency;
+
+void ir2hid_latency_reset(IR2HIDLatency* latency);
+
+// Record the time elapsed since start_cycles
+void ir2hid_latency_record(IR2HIDLatency* latency, uint32_t start_cycles);
+
+// Record the time between two DWT->CYCCNT values
+void ir2hid_latency_record_span(IR2HIDLatency* latency, uint32_t start_cycles, uint32_t end_cycles);
+
+// Percentiles over the retained samples, false if there are none
+bool ir2hid_latency_percentiles(const IR2HIDLatency* latency, uint32_t* p50, uint32_t* p99);
@@ -0,0 +1,258 @@
+#include "ir2hid_hid.h"
+
+#include <furi_hal.h>
+
+#define IR2HID_HID_NO_KEY 0
+
+// Queue entries are a keyboard code, or a consumer usage with this bit set
+#define IR2HID_HID_CONSUMER (1UL << 16)
+
+const IR2HIDHidSink ir2hid_hid_sink_usb = {
+    .ready = furi_hal_hid_is_connected,
+    .kb_press = furi_hal_hid_kb_press,
+    .kb_release = furi_hal_hid_kb_release,
+    .consumer_press = furi_hal_hid_consumer_key_press,
+    .consumer_release = furi_hal_hid_consumer_key_release,
+};
+
+static bool ir2hid_hid_sink_null_report(uint16_t hid_code) {
+    UNUSED(hid_code);
+    return true;
+}
+
+const IR2HIDHidSink ir2hid_hid_sink_null = {
+    .ready = NULL,
+    .kb_press = ir2hid_hid_sink_null_report,
+    .kb_release = ir2hid_hid_sink_null_report,
+    .consumer_press = ir2hid_hid_sink_null_report,
+    .consumer_release = ir2hid_hid_sink_null_report,
+};
+
+struct IR2HIDHidQueue {
+    const IR2HIDHidSink* sink;
+    FuriTimer* timer; // NULL for manual queues
+    uint32_t poll_ticks;
+    uint32_t min_press_ticks;
+
+    // Single producer (event loop) / single consumer (timer thread) ring
+    volatile uint32_t codes[IR2HID_HID_QUEUE_SIZE];
+    volatile uint32_t queued_at[IR2HID_HID_QUEUE_SIZE]; // tick
+    volatile uint32_t head; // written by producer
+    volatile uint32_t tail; // written by consumer
+
+    // Entry currently held down, only touched by the timer thread
+    uint32_t held_code;
+    uint32_t held_since;
+
+    // Report the sink keeps refusing, only touched by the timer thread
+    bool retrying;
+    uint32_t retry_since;
+    uint32_t retry_ticks;
+
+    // Meter, each counter has a single writer
+    volatile uint32_t reports_queued; // producer
+    volatile uint32_t reports_sent; // timer thread, like the rest below
+    volatile uint32_t reports_failed; // refused attempts, retries included
+    volatile uint32_t reports_dropped; // given up on
+    volatile uint32_t presses;
+    volatile uint32_t wait_ticks;
+};
+
+static bool ir2hid_hid_queue_report(const IR2HIDHidSink* sink, uint32_t entry, bool press) {
+    const uint16_t code = entry & 0xFFFF;
+    if(entry & IR2HID_HID_CONSUMER) {
+        return press ? sink->consumer_press(code) : sink->consumer_release(code);
+    }
+    return press ? sink->kb_press(code) : sink->kb_release(code);
+}
+
+// A release refused, or a press waiting for the sink to be ready, stays where it is
+// and is tried again on the next poll. Returns true once that has gone on for
+// longer than IR2HID_HID_RETRY_MS.
+static bool ir2hid_hid_queue_refused(IR2HIDHidQueue* queue, uint32_t now) {
+    queue->reports_failed++;
+    if(!queue->retrying) {
+        queue->retrying = true;
+        queue->retry_since = now;
+    }
+    if((now - queue->retry_since) < queue->retry_ticks) return false;
+
+    queue->retrying = false;
+    return true;
+}
+
+// At most one report is sent per poll so press/release never share a frame
+bool ir2hid_hid_queue_poll(IR2HIDHidQueue* queue, uint32_t now) {
+    if(queue->held_code != IR2HID_HID_NO_KEY) {
+        if((now - queue->held_since) >= queue->min_press_ticks) {
+            if(ir2hid_hid_queue_report(queue->sink, queue->held_code, false)) {
+                queue->retrying = false;
+                queue->reports_sent++;
+                queue->held_code = IR2HID_HID_NO_KEY;
+            } else if(ir2hid_hid_queue_refused(queue, now)) {
+                queue->reports_dropped++;
+                queue->held_code = IR2HID_HID_NO_KEY;
+            }
+        }
+    } else if(queue->tail != queue->head) {
+        const uint32_t code = queue->codes[queue->tail % IR2HID_HID_QUEUE_SIZE];
+        const uint32_t queued_at = queue->queued_at[queue->tail % IR2HID_HID_QUEUE_SIZE];
+        if(queue->sink->ready && !queue->sink->ready()) {
+            // Not pressed while the host is away, given up its release isn't needed
+            if(ir2hid_hid_queue_refused(queue, now)) {
+                queue->tail++;
+                queue->reports_dropped += 2;
+            }
+        } else if(ir2hid_hid_queue_report(queue->sink, code, true)) {
+            queue->tail++;
+            queue->retrying = false;
+            queue->held_code = code;
+            queue->held_since = now;
+            queue->reports_sent++;
+            queue->presses++;
+            queue->wait_ticks += now - queued_at;
+        } else {
+            // furi_hal_hid puts the key in its report before sending, pressing again
+            // would take another slot. Released right away so it can't stay held.
+            ir2hid_hid_queue_report(queue->sink, code, false);
+            queue->tail++;
+            queue->retrying = false;
+            queue->reports_failed++;
+            queue->reports_dropped += 2;
+        }
+    }
+
+    return queue->held_code != IR2HID_HID_NO_KEY || queue->tail != queue->head;
+}
+
+// Runs in the timer thread once per USB poll while there is work to do
+static void ir2hid_hid_queue_timer_callback(void* context) {
+    IR2HIDHidQueue* queue = context;
+
+    // Re-arm only while a key is held or queued, idle costs nothing
+    if(ir2hid_hid_queue_poll(queue, furi_get_tick())) {
+        furi_timer_start(queue->timer, queue->poll_ticks);
+    }
+}
+
+IR2HIDHidQueue* ir2hid_hid_queue_alloc_manual(const IR2HIDHidSink* sink) {
+    IR2HIDHidQueue* queue = malloc(sizeof(IR2HIDHidQueue));
+    memset(queue, 0, sizeof(IR2HIDHidQueue));
+
+    queue->sink = sink;
+    queue->timer = NULL;
+    queue->poll_ticks = furi_ms_to_ticks(IR2HID_HID_POLL_INTERVAL_MS);
+    queue->held_code = IR2HID_HID_NO_KEY;
+    queue->retrying = false;
+    queue->retry_ticks = furi_ms_to_ticks(IR2HID_HID_RETRY_MS);
+    ir2hid_hid_queue_set_min_press(queue, IR2HID_HID_MIN_PRESS_MS);
+
+    return queue;
+}
+
+IR2HIDHidQueue* ir2hid_hid_queue_alloc(void) {
+    IR2HIDHidQueue* queue = ir2hid_hid_queue_alloc_manual(&ir2hid_hid_sink_usb);
+    queue->timer = furi_timer_alloc(ir2hid_hid_queue_timer_callback, FuriTimerTypeOnce, queue);
+    return queue;
+}
+
+void ir2hid_hid_queue_free(IR2HIDHidQueue* queue) {
+    if(queue->timer) {
+        furi_timer_stop(queue->timer);
+        furi_timer_free(queue->timer);
+    }
+
+    if(queue->held_code != IR2HID_HID_NO_KEY) {
+        ir2hid_hid_queue_report(queue->sink, queue->held_code, false);
+    }
+
+    free(queue);
+}
+
+void ir2hid_hid_queue_set_min_press(IR2HIDHidQueue* queue, uint32_t min_press_ms) {
+    // Round up to whole polls so the press is always visible for at least one
+    queue->min_press_ticks = furi_ms_to_ticks(min_press_ms);
+    if(queue->min_press_ticks < queue->poll_ticks) {
+        queue->min_press_ticks = queue->poll_ticks;
+    }
+}
+
+static bool ir2hid_hid_queue_push(IR2HIDHidQueue* queue, uint32_t code) {
+    if((queue->head - queue->tail) >= IR2HID_HID_QUEUE_SIZE) return false;
+
+    queue->codes[queue->head % IR2HID_HID_QUEUE_SIZE] = code;
+    queue->queued_at[queue->head % IR2HID_HID_QUEUE_SIZE] = furi_get_tick();
+    queue->head++;
+    queue->reports_queued += 2;
+
+    if(queue->timer && !furi_timer_is_running(queue->timer)) {
+        // Kick off on the next tick, the callback keeps itself paced from there
+        furi_timer_start(queue->timer, 1);
+    }
+    return true;
+}
+
+bool ir2hid_hid_queue_tap(IR2HIDHidQueue* queue, uint16_t hid_code) {
+    if(hid_code == IR2HID_HID_NO_KEY) return false;
+    return ir2hid_hid_queue_push(queue, hid_code);
+}
+
+bool ir2hid_hid_queue_consumer(IR2HIDHidQueue* queue, uint16_t usage) {
+    if(usage == IR2HID_HID_NO_KEY) return false;
+    return ir2hid_hid_queue_push(queue, usage | IR2HID_HID_CONSUMER);
+}
+
+// Next character of UTF-8 text as Latin-1, 0 for anything outside Latin-1
+static uint8_t ir2hid_hid_next_char(const char** text) {
+    const uint8_t* p = (const uint8_t*)*text;
+    if(p[0] < 0x80) {
+        *text += 1;
+        return p[0];
+    }
+
+    // Latin-1 is U+0080..U+00FF, always a two byte sequence
+    if((p[0] & 0xE0) == 0xC0 && (p[1] & 0xC0) == 0x80) {
+        *text += 2;
+        const uint32_t code_point = ((p[0] & 0x1F) << 6) | (p[1] & 0x3F);
+        return code_point < IR2HID_LAYOUT_CHARS ? code_point : 0;
+    }
+
+    // Longer or broken sequence, skip the lead byte and its continuation bytes
+    p++;
+    while((*p & 0xC0) == 0x80) p++;
+    *text = (const char*)p;
+    return 0;
+}
+
+bool ir2hid_hid_queue_text(IR2HIDHidQueue* queue, IR2HIDLayout layout, const char* text) {
+    const uint16_t space = ir2hid_layout_code(layout, ' ');
+
+    // A dead key takes a space after it
+    size_t taps = 0;
+    for(const char* p = text; *p;) {
+        const uint16_t code = ir2hid_layout_code(layout, ir2hid_hid_next_char(&p));
+        if(code) taps += (code & IR2HID_LAYOUT_DEAD) ? 2 : 1;
+    }
+    if(taps == 0 || taps > IR2HID_HID_QUEUE_SIZE - (queue->head - queue->tail)) return false;
+
+    for(const char* p = text; *p;) {
+        const uint16_t code = ir2hid_layout_code(layout, ir2hid_hid_next_char(&p));
+        if(!code) continue;
+        ir2hid_hid_queue_tap(queue, code & ~IR2HID_LAYOUT_DEAD);
+        if(code & IR2HID_LAYOUT_DEAD) ir2hid_hid_queue_tap(queue, space);
+    }
+    return true;
+}
+
+// --- Report Meter ---
+
+void ir2hid_hid_queue_meter(const IR2HIDHidQueue* queue, IR2HIDHidMeter* meter) {
+    meter->queued = queue->reports_queued;
+    meter->sent = queue->reports_sent;
+    meter->failed = queue->reports_failed;
+    meter->dropped = queue->reports_dropped;
+    meter->presses = queue->presses;
+    meter->wait_ticks = queue->wait_ticks;
+    meter->backlog = (queue->head - queue->tail) * 2 +
+                     (queue->held_code != IR2HID_HID_NO_KEY ? 1 : 0);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <furi.h>
+
+#include "ir2hid_layouts.h"
+
+// --- HID Report Scheduler ---
+//
+// Keystrokes are queued here instead of being sent straight from the main loop.
+// A press and its release are emitted on different USB polls, so the host never
+// sees both reports inside a single polling window.
+
+// Polling interval of the firmware's usb_hid interrupt endpoint (bInterval, 1 ms frames)
+#define IR2HID_HID_POLL_INTERVAL_MS 2
+
+// Default time a key is held down before its release report is sent
+#define IR2HID_HID_MIN_PRESS_MS 10
+
+// How long a key waits for a sink that isn't ready, and a refused release is
+// retried, once per poll, before it's dropped. Covers the host being busy, not
+// one that went to sleep or away. A refused press is never sent again.
+#define IR2HID_HID_RETRY_MS 1000
+
+// Max keystrokes waiting to be sent, a whole text action with dead keys fits
+#define IR2HID_HID_QUEUE_SIZE 128
+
+// Where reports end up. Consumer usages go in their own report, a held
+// consumer key never changes the keyboard report and the other way around.
+typedef struct {
+    bool (*ready)(void); // NULL if always ready, presses wait in the queue until it is
+    bool (*kb_press)(uint16_t hid_code);
+    bool (*kb_release)(uint16_t hid_code);
+    bool (*consumer_press)(uint16_t usage);
+    bool (*consumer_release)(uint16_t usage);
+} IR2HIDHidSink;
+
+// furi_hal_hid, the real USB keyboard
+extern const IR2HIDHidSink ir2hid_hid_sink_usb;
+// Accepts and drops every report, for benchmarks
+extern const IR2HIDHidSink ir2hid_hid_sink_null;
+
+typedef struct IR2HIDHidQueue IR2HIDHidQueue;
+
+// Queue paced by its own timer, sending to the USB sink
+IR2HIDHidQueue* ir2hid_hid_queue_alloc(void);
+
+// Queue without a timer, reports only go out on ir2hid_hid_queue_poll
+IR2HIDHidQueue* ir2hid_hid_queue_alloc_manual(const IR2HIDHidSink* sink);
+
+// Releases any held key, then frees the scheduler
+void ir2hid_hid_queue_free(IR2HIDHidQueue* queue);
+
+void ir2hid_hid_queue_set_min_press(IR2HIDHidQueue* queue, uint32_t min_press_ms);
+
+// Queue a press + release of a keyboard code. Never blocks, returns false if the queue is full.
+bool ir2hid_hid_queue_tap(IR2HIDHidQueue* queue, uint16_t hid_code);
+
+// Same for a Consumer page usage, e.g. HID_CONSUMER_SLEEP
+bool ir2hid_hid_queue_consumer(IR2HIDHidQueue* queue, uint16_t usage);
+
+// Queue the keystrokes typing UTF-8 text on a host with the given layout. Characters
+// the layout can't type are skipped. All or nothing, returns false if it doesn't fit.
+bool ir2hid_hid_queue_text(IR2HIDHidQueue* queue, IR2HIDLayout layout, const char* text);
+
+// Send at most one report due at tick `now`, returns true while work is left.
+// Only for manual queues, paced queues call this from their timer.
+bool ir2hid_hid_queue_poll(IR2HIDHidQueue* queue, uint32_t now);
+
+// --- Report Meter ---
+//
+// Running totals of the reports going through the queue, a reader takes two
+// snapshots to get rates. A report is sent once the sink accepted it, for USB
+// that is once the endpoint took it, i.e. the host polled the previous one.
+
+typedef struct {
+    uint32_t queued; // reports, a keystroke is a press and a release
+    uint32_t sent;
+    uint32_t failed; // refused or not ready, e.g. the host stopped polling, counted per try
+    uint32_t dropped; // a refused press and its release, or refused until IR2HID_HID_RETRY_MS ran out
+    uint32_t presses; // press reports sent
+    uint32_t wait_ticks; // queued to sent, summed over those presses
+    uint32_t backlog; // reports still waiting, including a held key's release
+} IR2HIDHidMeter;
+
+void ir2hid_hid_queue_meter(const IR2HIDHidQueue* queue, IR2HIDHidMeter* meter);
@@ -0,0 +1,313 @@
+#include "ir2hid_ir_rx.h"
+
+#include <furi_hal.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- Early NEC Decoder ---
+
+// Timing windows in us, wider than the firmware decoder's, it has the last word
+#define IR2HID_NEC_HEADER_MARK_MIN 7000
+#define IR2HID_NEC_HEADER_MARK_MAX 11000
+#define IR2HID_NEC_HEADER_SPACE_MIN 3500 // a repeat frame has 2250
+#define IR2HID_NEC_HEADER_SPACE_MAX 5500
+#define IR2HID_NEC_BIT_MARK_MIN 300
+#define IR2HID_NEC_BIT_MARK_MAX 900
+#define IR2HID_NEC_ZERO_SPACE_MAX 900 // 560
+#define IR2HID_NEC_ONE_SPACE_MIN 1300 // 1690
+#define IR2HID_NEC_ONE_SPACE_MAX 2000
+
+#define IR2HID_NEC_FRAME_BITS 32
+
+static inline bool ir2hid_nec_in(uint32_t duration, uint32_t min, uint32_t max) {
+    return duration >= min && duration <= max;
+}
+
+void ir2hid_nec_early_reset(IR2HIDNecEarly* decoder) {
+    decoder->state = IR2HIDNecEarlyStateIdle;
+    decoder->bits = 0;
+    decoder->data = 0;
+}
+
+// Codes a frame starting with prefix can decode to. The firmware decoder makes
+// it NEC only when both check bytes match, the command check is still to come,
+// so NEC is a candidate when the address check matches. NECext always is, with
+// only the command's low byte known.
+#define IR2HID_NEC_EARLY_PATTERNS 2
+
+static size_t ir2hid_nec_early_patterns(
+    uint32_t prefix,
+    InfraredMessage* patterns,
+    uint32_t* command_masks) {
+    const uint8_t address = prefix;
+    const uint8_t address_check = prefix >> 8;
+    const uint8_t command = prefix >> 16;
+    size_t count = 0;
+
+    if((address ^ address_check) == 0xFF) {
+        patterns[count] = (InfraredMessage){
+            .protocol = InfraredProtocolNEC, .address = address, .command = command};
+        command_masks[count++] = 0xFFFFFF;
+    }
+    patterns[count] = (InfraredMessage){
+        .protocol = InfraredProtocolNECext, .address = prefix & 0xFFFF, .command = command};
+    command_masks[count++] = 0xFF;
+    return count;
+}
+
+bool ir2hid_nec_early_feed(
+    IR2HIDNecEarly* decoder,
+    bool level,
+    uint32_t duration,
+    uint32_t* prefix) {
+    switch(decoder->state) {
+    case IR2HIDNecEarlyStateIdle:
+        break;
+    case IR2HIDNecEarlyStateHeaderSpace:
+        if(!level && ir2hid_nec_in(
+                         duration, IR2HID_NEC_HEADER_SPACE_MIN, IR2HID_NEC_HEADER_SPACE_MAX)) {
+            decoder->state = IR2HIDNecEarlyStateBitMark;
+            decoder->bits = 0;
+            decoder->data = 0;
+            return false;
+        }
+        break;
+    case IR2HIDNecEarlyStateBitMark:
+        if(level && ir2hid_nec_in(duration, IR2HID_NEC_BIT_MARK_MIN, IR2HID_NEC_BIT_MARK_MAX)) {
+            // The mark after the last bit ends the frame
+            decoder->state = decoder->bits == IR2HID_NEC_FRAME_BITS ?
+                                 IR2HIDNecEarlyStateIdle :
+                                 IR2HIDNecEarlyStateBitSpace;
+            return false;
+        }
+        break;
+    case IR2HIDNecEarlyStateBitSpace: {
+        const bool zero = duration >= IR2HID_NEC_BIT_MARK_MIN &&
+                          duration <= IR2HID_NEC_ZERO_SPACE_MAX;
+        const bool one =
+            ir2hid_nec_in(duration, IR2HID_NEC_ONE_SPACE_MIN, IR2HID_NEC_ONE_SPACE_MAX);
+        if(!level && (zero || one)) {
+            if(one) decoder->data |= 1UL << decoder->bits;
+            decoder->bits++;
+            decoder->state = IR2HIDNecEarlyStateBitMark;
+            if(decoder->bits != IR2HID_NEC_EARLY_COMMIT_BITS) return false;
+
+            *prefix = decoder->data;
+            return true;
+        }
+        break;
+    }
+    }
+
+    // Anything unexpected ends the frame, it may be the header of the next one
+    decoder->state =
+        level && ir2hid_nec_in(duration, IR2HID_NEC_HEADER_MARK_MIN, IR2HID_NEC_HEADER_MARK_MAX) ?
+            IR2HIDNecEarlyStateHeaderSpace :
+            IR2HIDNecEarlyStateIdle;
+    return false;
+}
+
+// --- Raw Receiver ---
+
+typedef struct {
+    uint32_t duration; // us
+    uint32_t cycles; // DWT->CYCCNT when it ended
+    bool level;
+    bool timeout; // silence, the frame is over
+} IR2HIDIrRxTiming;
+
+// Results of one timing: at most Cancel and Frame of the last frame, then a Commit
+#define IR2HID_IR_RX_RESULTS 3
+
+struct IR2HIDIrRx {
+    FuriThreadId thread;
+    uint32_t flag;
+    IR2HIDIrRxMatch match;
+    void* context;
+    InfraredDecoderHandler* decoder;
+    IR2HIDNecEarly early;
+
+    // Single producer (IR timer ISR) / single consumer (thread) ring
+    IR2HIDIrRxTiming timings[IR2HID_IR_RX_RING_SIZE];
+    volatile uint32_t head; // written by producer
+    volatile uint32_t tail; // written by consumer
+    volatile uint32_t overruns;
+
+    // Only touched by the consumer
+    bool committed;
+    InfraredMessage commit;
+    uint32_t commit_cycles;
+    IR2HIDIrRxResult results[IR2HID_IR_RX_RESULTS];
+    uint8_t result_count;
+    uint8_t result_next;
+};
+
+static void ir2hid_ir_rx_push(IR2HIDIrRx* rx, bool level, uint32_t duration, bool timeout) {
+    if((rx->head - rx->tail) >= IR2HID_IR_RX_RING_SIZE) {
+        rx->overruns++;
+        return;
+    }
+
+    IR2HIDIrRxTiming* timing = &rx->timings[rx->head % IR2HID_IR_RX_RING_SIZE];
+    timing->duration = duration;
+    timing->cycles = DWT->CYCCNT;
+    timing->level = level;
+    timing->timeout = timeout;
+    // Publish the timing only once it's fully written
+    __DMB();
+    rx->head++;
+    furi_thread_flags_set(rx->thread, rx->flag);
+}
+
+static bool ir2hid_ir_rx_pop(IR2HIDIrRx* rx, IR2HIDIrRxTiming* timing) {
+    if(rx->tail == rx->head) return false;
+
+    __DMB();
+    *timing = rx->timings[rx->tail % IR2HID_IR_RX_RING_SIZE];
+    __DMB();
+    rx->tail++;
+    return true;
+}
+
+static void ir2hid_ir_rx_capture_isr(void* context, bool level, uint32_t duration) {
+    ir2hid_ir_rx_push(context, level, duration, false);
+}
+
+static void ir2hid_ir_rx_timeout_isr(void* context) {
+    ir2hid_ir_rx_push(context, false, 0, true);
+}
+
+IR2HIDIrRx* ir2hid_ir_rx_alloc(
+    FuriThreadId thread,
+    uint32_t flag,
+    IR2HIDIrRxMatch match,
+    void* context) {
+    IR2HIDIrRx* rx = malloc(sizeof(IR2HIDIrRx));
+    memset(rx, 0, sizeof(IR2HIDIrRx));
+
+    rx->thread = thread;
+    rx->flag = flag;
+    rx->match = match;
+    rx->context = context;
+    rx->decoder = infrared_alloc_decoder();
+    ir2hid_nec_early_reset(&rx->early);
+
+    return rx;
+}
+
+void ir2hid_ir_rx_free(IR2HIDIrRx* rx) {
+    infrared_free_decoder(rx->decoder);
+    free(rx);
+}
+
+void ir2hid_ir_rx_start(IR2HIDIrRx* rx) {
+    furi_hal_infrared_async_rx_set_capture_isr_callback(ir2hid_ir_rx_capture_isr, rx);
+    furi_hal_infrared_async_rx_set_timeout_isr_callback(ir2hid_ir_rx_timeout_isr, rx);
+    furi_hal_infrared_async_rx_start();
+    furi_hal_infrared_async_rx_set_timeout(IR2HID_IR_RX_TIMEOUT_US);
+}
+
+void ir2hid_ir_rx_stop(IR2HIDIrRx* rx) {
+    furi_hal_infrared_async_rx_set_timeout_isr_callback(NULL, NULL);
+    furi_hal_infrared_async_rx_set_capture_isr_callback(NULL, NULL);
+    furi_hal_infrared_async_rx_stop();
+
+    // The ISR is off, this thread is the producer now. Whatever was being
+    // received is cut off, the consumer resets its decoders on this.
+    ir2hid_ir_rx_push(rx, false, 0, true);
+}
+
+static void ir2hid_ir_rx_emit(
+    IR2HIDIrRx* rx,
+    IR2HIDIrRxEvent type,
+    const InfraredMessage* message,
+    uint32_t cycles) {
+    IR2HIDIrRxResult* result = &rx->results[rx->result_count++];
+    result->type = type;
+    if(message) result->message = *message;
+    result->cycles = cycles;
+    result->commit_cycles = rx->commit_cycles;
+}
+
+static bool ir2hid_ir_rx_same_code(const InfraredMessage* a, const InfraredMessage* b) {
+    return a->protocol == b->protocol && a->address == b->address && a->command == b->command;
+}
+
+// The one mapped code a frame starting with prefix can decode to, false if there
+// is none or more than one
+static bool ir2hid_ir_rx_early_code(IR2HIDIrRx* rx, uint32_t prefix, InfraredMessage* code) {
+    InfraredMessage patterns[IR2HID_NEC_EARLY_PATTERNS];
+    uint32_t command_masks[IR2HID_NEC_EARLY_PATTERNS];
+    const size_t pattern_count = ir2hid_nec_early_patterns(prefix, patterns, command_masks);
+
+    size_t matches = 0;
+    for(size_t i = 0; i < pattern_count && matches < 2; i++) {
+        InfraredMessage match;
+        const size_t count = rx->match(rx->context, &patterns[i], command_masks[i], &match);
+        if(count > 0 && matches == 0) *code = match;
+        matches += count;
+    }
+    return matches == 1;
+}
+
+// One timing through both decoders
+static void ir2hid_ir_rx_decode(IR2HIDIrRx* rx, const IR2HIDIrRxTiming* timing) {
+    const InfraredMessage* decoded;
+    InfraredMessage early;
+    uint32_t prefix;
+    bool commit = false;
+
+    if(timing->timeout) {
+        // Protocols without a stop bit only finish on silence
+        decoded = infrared_check_decoder_ready(rx->decoder);
+        infrared_reset_decoder(rx->decoder);
+        ir2hid_nec_early_reset(&rx->early);
+    } else {
+        decoded = infrared_decode(rx->decoder, timing->level, timing->duration);
+        commit = ir2hid_nec_early_feed(&rx->early, timing->level, timing->duration, &prefix) &&
+                 ir2hid_ir_rx_early_code(rx, prefix, &early);
+    }
+
+    if(decoded && rx->committed) {
+        rx->committed = false;
+        if(ir2hid_ir_rx_same_code(decoded, &rx->commit)) {
+            ir2hid_ir_rx_emit(rx, IR2HIDIrRxEventConfirm, decoded, timing->cycles);
+        } else {
+            // NEC42, an unmapped code sharing the prefix or a frame we misread
+            ir2hid_ir_rx_emit(rx, IR2HIDIrRxEventCancel, NULL, timing->cycles);
+            ir2hid_ir_rx_emit(rx, IR2HIDIrRxEventFrame, decoded, timing->cycles);
+        }
+    } else if(decoded) {
+        ir2hid_ir_rx_emit(rx, IR2HIDIrRxEventFrame, decoded, timing->cycles);
+    } else if(
+        rx->committed &&
+        (timing->timeout || rx->early.state == IR2HIDNecEarlyStateHeaderSpace)) {
+        // Silence or a new header before the committed frame decoded
+        rx->committed = false;
+        ir2hid_ir_rx_emit(rx, IR2HIDIrRxEventCancel, NULL, timing->cycles);
+    }
+
+    if(commit) {
+        rx->committed = true;
+        rx->commit = early;
+        rx->commit_cycles = timing->cycles;
+        ir2hid_ir_rx_emit(rx, IR2HIDIrRxEventCommit, &early, timing->cycles);
+    }
+}
+
+bool ir2hid_ir_rx_process(IR2HIDIrRx* rx, IR2HIDIrRxResult* result) {
+    IR2HIDIrRxTiming timing;
+    while(rx->result_next == rx->result_count) {
+        if(!ir2hid_ir_rx_pop(rx, &timing)) return false;
+        rx->result_count = 0;
+        rx->result_next = 0;
+        ir2hid_ir_rx_decode(rx, &timing);
+    }
+
+    *result = rx->results[rx->result_next++];
+    return true;
+}
+
+uint32_t ir2hid_ir_rx_overruns(const IR2HIDIrRx* rx) {
+    return rx->overruns;
+}
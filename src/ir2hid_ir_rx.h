@@ -0,0 +1,93 @@
+#pragma once
+
+#include <furi.h>
+#include <infrared.h>
+
+// --- Early NEC Decoder ---
+//
+// A NEC frame is ~67 ms on the air: 9 ms + 4.5 ms header, then address, inverted
+// address (or the high address byte for NECext), command and inverted command,
+// 8 bits each, LSB first. After the first 24 bits only the last byte is missing:
+// a NEC frame's command check, or the high command byte of a NECext frame. This
+// decoder follows the raw timings and reports those 24 bits, the code is committed
+// when a single LUT row can match them. The firmware decoder still decodes the
+// whole frame to confirm it.
+
+#define IR2HID_NEC_EARLY_COMMIT_BITS 24
+
+typedef enum {
+    IR2HIDNecEarlyStateIdle,
+    IR2HIDNecEarlyStateHeaderSpace,
+    IR2HIDNecEarlyStateBitMark,
+    IR2HIDNecEarlyStateBitSpace,
+} IR2HIDNecEarlyState;
+
+typedef struct {
+    IR2HIDNecEarlyState state;
+    uint8_t bits; // received so far
+    uint32_t data; // LSB first
+} IR2HIDNecEarly;
+
+void ir2hid_nec_early_reset(IR2HIDNecEarly* decoder);
+
+// Feed one mark (level true) or space, returns true with the first 24 bits in
+// prefix (LSB first) once they are in.
+bool ir2hid_nec_early_feed(
+    IR2HIDNecEarly* decoder,
+    bool level,
+    uint32_t duration,
+    uint32_t* prefix);
+
+// --- Raw Receiver ---
+//
+// Replaces InfraredWorker reception when early commit is on. The IR timer ISR
+// pushes every timing into a ring and sets a flag on the consumer thread, which
+// runs both the early NEC decoder and the firmware decoder on them. Reception
+// of every other protocol is the same as through the worker.
+
+#define IR2HID_IR_RX_RING_SIZE 128 // power of 2, a NEC frame is 68 timings
+#define IR2HID_IR_RX_TIMEOUT_US 150000 // silence that ends a frame, like the worker
+
+typedef enum {
+    IR2HIDIrRxEventFrame, // decoded frame without an early commit, dispatch it as usual
+    IR2HIDIrRxEventCommit, // code known before the end of the frame, dispatch it now
+    IR2HIDIrRxEventConfirm, // frame decoded to the committed code, already dispatched
+    IR2HIDIrRxEventCancel, // committed frame broke off or decoded to another code
+} IR2HIDIrRxEvent;
+
+typedef struct {
+    IR2HIDIrRxEvent type;
+    InfraredMessage message; // not set for Cancel
+    uint32_t cycles; // DWT->CYCCNT of the timing that completed it
+    uint32_t commit_cycles; // Confirm: DWT->CYCCNT of the commit
+} IR2HIDIrRxResult;
+
+typedef struct IR2HIDIrRx IR2HIDIrRx;
+
+// Number of mapped codes matching pattern in the command bits of command_mask,
+// 2 for two or more, match is then the first. Called from the consumer thread.
+typedef size_t (*IR2HIDIrRxMatch)(
+    void* context,
+    const InfraredMessage* pattern,
+    uint32_t command_mask,
+    InfraredMessage* match);
+
+// flag is set on thread for every timing received, match decides early commits
+IR2HIDIrRx* ir2hid_ir_rx_alloc(
+    FuriThreadId thread,
+    uint32_t flag,
+    IR2HIDIrRxMatch match,
+    void* context);
+
+void ir2hid_ir_rx_free(IR2HIDIrRx* rx);
+
+void ir2hid_ir_rx_start(IR2HIDIrRx* rx);
+
+void ir2hid_ir_rx_stop(IR2HIDIrRx* rx);
+
+// Decode pending timings up to the next result, false once the ring is empty.
+// Only called from the thread given to ir2hid_ir_rx_alloc.
+bool ir2hid_ir_rx_process(IR2HIDIrRx* rx, IR2HIDIrRxResult* result);
+
+// Timings dropped because the ring was full
+uint32_t ir2hid_ir_rx_overruns(const IR2HIDIrRx* rx);
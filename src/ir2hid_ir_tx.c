@@ -0,0 +1,138 @@
+#include "ir2hid_ir_tx.h"
+
+#include "ir2hid_ir_rx.h"
+
+#include <infrared_transmit.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- Sinks ---
+
+static void ir2hid_ir_tx_sink_infrared_send(void* context, const InfraredMessage* message) {
+    InfraredWorker* worker = context;
+    infrared_worker_rx_stop(worker);
+    infrared_send(message, 1);
+    infrared_worker_rx_start(worker);
+}
+
+const IR2HIDIrTxSink ir2hid_ir_tx_sink_infrared = {
+    .send = ir2hid_ir_tx_sink_infrared_send,
+};
+
+static void ir2hid_ir_tx_sink_raw_rx_send(void* context, const InfraredMessage* message) {
+    IR2HIDIrRx* rx = context;
+    ir2hid_ir_rx_stop(rx);
+    infrared_send(message, 1);
+    ir2hid_ir_rx_start(rx);
+}
+
+const IR2HIDIrTxSink ir2hid_ir_tx_sink_raw_rx = {
+    .send = ir2hid_ir_tx_sink_raw_rx_send,
+};
+
+// --- Transmit Thread ---
+
+typedef struct {
+    InfraredMessage message;
+    uint32_t until; // tick the echo window ends, UINT32_MAX while being sent
+} IR2HIDIrTxEcho;
+
+struct IR2HIDIrTx {
+    const IR2HIDIrTxSink* sink;
+    void* context;
+    FuriThread* thread;
+    FuriMessageQueue* queue; // InfraredMessage, InfraredProtocolUnknown stops the thread
+
+    FuriMutex* mutex; // echoes
+    IR2HIDIrTxEcho echoes[IR2HID_IR_TX_ECHO_SIZE]; // ring, oldest overwritten
+    uint32_t echo_next;
+
+    uint32_t sent;
+    uint32_t echoes_ignored;
+};
+
+static bool ir2hid_ir_tx_same_code(const InfraredMessage* a, const InfraredMessage* b) {
+    return a->protocol == b->protocol && a->address == b->address && a->command == b->command;
+}
+
+static int32_t ir2hid_ir_tx_thread(void* ctx) {
+    IR2HIDIrTx* tx = ctx;
+    const uint32_t window_ticks = furi_ms_to_ticks(IR2HID_IR_TX_ECHO_WINDOW_MS);
+
+    InfraredMessage message;
+    while(furi_message_queue_get(tx->queue, &message, FuriWaitForever) == FuriStatusOk) {
+        if(message.protocol == InfraredProtocolUnknown) break;
+
+        // Window opens before the frame goes out, reception may resume mid-send
+        furi_mutex_acquire(tx->mutex, FuriWaitForever);
+        IR2HIDIrTxEcho* echo = &tx->echoes[tx->echo_next++ % IR2HID_IR_TX_ECHO_SIZE];
+        echo->message = message;
+        echo->until = UINT32_MAX;
+        furi_mutex_release(tx->mutex);
+
+        tx->sink->send(tx->context, &message);
+        tx->sent++;
+
+        // Only this thread writes echoes, the slot is still ours
+        furi_mutex_acquire(tx->mutex, FuriWaitForever);
+        echo->until = furi_get_tick() + window_ticks;
+        furi_mutex_release(tx->mutex);
+    }
+
+    return 0;
+}
+
+IR2HIDIrTx* ir2hid_ir_tx_alloc(const IR2HIDIrTxSink* sink, void* context) {
+    IR2HIDIrTx* tx = malloc(sizeof(IR2HIDIrTx));
+    memset(tx, 0, sizeof(IR2HIDIrTx));
+    tx->sink = sink;
+    tx->context = context;
+    tx->queue = furi_message_queue_alloc(IR2HID_IR_TX_QUEUE_SIZE + 1, sizeof(InfraredMessage));
+    tx->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    for(size_t i = 0; i < IR2HID_IR_TX_ECHO_SIZE; i++) {
+        tx->echoes[i].message.protocol = InfraredProtocolUnknown;
+    }
+
+    tx->thread = furi_thread_alloc_ex("IR2HIDIrTx", 1024, ir2hid_ir_tx_thread, tx);
+    furi_thread_start(tx->thread);
+    return tx;
+}
+
+void ir2hid_ir_tx_free(IR2HIDIrTx* tx) {
+    // Pending frames are dropped, the stop request goes to the front of the queue
+    furi_message_queue_reset(tx->queue);
+    const InfraredMessage stop = {.protocol = InfraredProtocolUnknown};
+    furi_message_queue_put(tx->queue, &stop, FuriWaitForever);
+    furi_thread_join(tx->thread);
+    furi_thread_free(tx->thread);
+
+    furi_message_queue_free(tx->queue);
+    furi_mutex_free(tx->mutex);
+    free(tx);
+}
+
+bool ir2hid_ir_tx_send(IR2HIDIrTx* tx, const InfraredMessage* message) {
+    // The last queue slot is kept for the stop request
+    if(furi_message_queue_get_count(tx->queue) >= IR2HID_IR_TX_QUEUE_SIZE) return false;
+    return furi_message_queue_put(tx->queue, message, 0) == FuriStatusOk;
+}
+
+bool ir2hid_ir_tx_is_echo(IR2HIDIrTx* tx, const InfraredMessage* message, uint32_t now) {
+    bool echo = false;
+
+    furi_mutex_acquire(tx->mutex, FuriWaitForever);
+    for(size_t i = 0; i < IR2HID_IR_TX_ECHO_SIZE && !echo; i++) {
+        const IR2HIDIrTxEcho* sent = &tx->echoes[i];
+        echo = ir2hid_ir_tx_same_code(&sent->message, message) &&
+               (sent->until == UINT32_MAX || (int32_t)(sent->until - now) > 0);
+    }
+    if(echo) tx->echoes_ignored++;
+    furi_mutex_release(tx->mutex);
+
+    return echo;
+}
+
+void ir2hid_ir_tx_stats(const IR2HIDIrTx* tx, uint32_t* sent, uint32_t* echoes) {
+    *sent = tx->sent;
+    *echoes = tx->echoes_ignored;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <furi.h>
+#include <infrared.h>
+#include <infrared_worker.h>
+
+// --- IR Transmit Queue ---
+//
+// IR codes relayed by IrTransmit rows are queued here and sent by a thread of
+// their own, so the lookup path never waits for a frame to go out. The receiver
+// would decode our own frame, every code sent is ignored on reception for a
+// short echo window afterwards.
+
+// Max frames waiting to be sent
+#define IR2HID_IR_TX_QUEUE_SIZE 8
+
+// Time after a frame is sent during which receiving the same code is an echo
+#define IR2HID_IR_TX_ECHO_WINDOW_MS 150
+
+// Recently sent codes checked for echoes
+#define IR2HID_IR_TX_ECHO_SIZE 4
+
+// Where frames end up, send may block, it runs on the transmit thread
+typedef struct {
+    void (*send)(void* context, const InfraredMessage* message);
+} IR2HIDIrTxSink;
+
+// The IR LED, context is the app's InfraredWorker. Reception is paused while a
+// frame is sent, the receiver and the transmitter share the IR timer.
+extern const IR2HIDIrTxSink ir2hid_ir_tx_sink_infrared;
+
+// The IR LED with early commit on, context is the app's IR2HIDIrRx
+extern const IR2HIDIrTxSink ir2hid_ir_tx_sink_raw_rx;
+
+typedef struct IR2HIDIrTx IR2HIDIrTx;
+
+IR2HIDIrTx* ir2hid_ir_tx_alloc(const IR2HIDIrTxSink* sink, void* context);
+
+// Drops frames that haven't been sent yet, waits for the one being sent
+void ir2hid_ir_tx_free(IR2HIDIrTx* tx);
+
+// Queue a frame. Never blocks, returns false if the queue is full.
+bool ir2hid_ir_tx_send(IR2HIDIrTx* tx, const InfraredMessage* message);
+
+// True if a received frame is one of ours, sent less than the echo window before now
+bool ir2hid_ir_tx_is_echo(IR2HIDIrTx* tx, const InfraredMessage* message, uint32_t now);
+
+// Frames sent and echoes ignored so far
+void ir2hid_ir_tx_stats(const IR2HIDIrTx* tx, uint32_t* sent, uint32_t* echoes);
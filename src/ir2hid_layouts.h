@@ -0,0 +1,33 @@
+#pragma once
+
+#include <furi.h>
+
+// --- Keyboard Layouts ---
+//
+// Character to HID code tables for text actions, one per host keyboard layout.
+// Generated into const arrays in flash by tools/gen_layouts.py, a character is
+// converted with a single table index.
+
+typedef enum {
+    IR2HIDLayoutUS,
+    IR2HIDLayoutUK,
+    IR2HIDLayoutDE,
+    IR2HIDLayoutFR,
+    IR2HIDLayoutCount,
+} IR2HIDLayout;
+
+// Tables are indexed by Latin-1 character
+#define IR2HID_LAYOUT_CHARS 256
+
+// Set on characters typed with a dead key, space has to follow to get the character
+#define IR2HID_LAYOUT_DEAD 0x8000
+
+// HID code as in hid_command, 0 if the layout can't type the character
+extern const uint16_t* const ir2hid_layout_tables[IR2HIDLayoutCount];
+
+// Lower case names used by the @layout directive, e.g. "de"
+extern const char* const ir2hid_layout_names[IR2HIDLayoutCount];
+
+static inline uint16_t ir2hid_layout_code(IR2HIDLayout layout, uint8_t latin1) {
+    return ir2hid_layout_tables[layout][latin1];
+}
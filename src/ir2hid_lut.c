@@ -0,0 +1,1213 @@
+#include "ir2hid_hid.h"
+#include "ir2hid_lut.h"
+#include "ir2hid_lut_pages.h"
+
+#include <furi_hal.h>
+#include <stddef.h>
+#include <storage/storage.h>
+#include <string.h>
+
+#define TAG "IR2HID"
+
+// --- CSV Helpers ---
+
+// Decode 4 ASCII hex digits packed in a little-endian word (SWAR).
+// Validates all 4 bytes and converts them with a handful of 32-bit operations.
+static inline bool ir2hid_hex_word_decode(uint32_t word, uint32_t* out) {
+    // Bytes >= 0x80 are never hex, rejecting them keeps the per-byte adds below carry-free
+    if(word & 0x80808080U) return false;
+
+    // Per-byte range checks, high bit of each byte is set when in range
+    const uint32_t digit = (word + 0x50505050U) & ~(word + 0x46464646U); // '0'..'9'
+    const uint32_t lower = word | 0x20202020U;
+    const uint32_t alpha = (lower + 0x1F1F1F1FU) & ~(lower + 0x19191919U); // 'a'..'f'
+    if(((digit | alpha) & 0x80808080U) != 0x80808080U) return false;
+
+    // '0'-'9' have bit 6 clear and map to 0-9, letters have it set and map to 1-6 + 9
+    const uint32_t nibbles = (word & 0x0F0F0F0FU) + ((word >> 6) & 0x01010101U) * 9;
+
+    // Byte 0 is the most significant digit
+    const uint32_t pairs = ((nibbles & 0x000F000FU) << 4) | ((nibbles >> 8) & 0x000F000FU);
+    *out = ((pairs & 0xFF) << 8) | ((pairs >> 16) & 0xFF);
+    return true;
+}
+
+bool ir2hid_parse_hex_field(const IR2HIDCsvField* field, uint32_t* out) {
+    const char* s = field->start;
+    size_t len = field->len;
+
+    if(len >= 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+        s += 2;
+        len -= 2;
+    }
+    while(len > 8 && s[0] == '0') {
+        s++;
+        len--;
+    }
+    if(len == 0 || len > 8) return false;
+
+    // Right-align into 8 digits padded with '0' and decode as two words
+    char digits[8];
+    memset(digits, '0', sizeof(digits));
+    memcpy(&digits[sizeof(digits) - len], s, len);
+
+    uint32_t hi_word, lo_word, hi, lo;
+    memcpy(&hi_word, &digits[0], sizeof(uint32_t));
+    memcpy(&lo_word, &digits[4], sizeof(uint32_t));
+    if(!ir2hid_hex_word_decode(hi_word, &hi) || !ir2hid_hex_word_decode(lo_word, &lo)) {
+        return false;
+    }
+
+    *out = (hi << 16) | lo;
+    return true;
+}
+
+// Plain decimal up to max, used for cooldown_ms and settings
+static bool ir2hid_parse_dec_field(const IR2HIDCsvField* field, uint32_t max, uint32_t* out) {
+    if(field->len == 0 || field->len > 10) return false;
+
+    uint64_t value = 0;
+    for(size_t i = 0; i < field->len; i++) {
+        const char c = field->start[i];
+        if(c < '0' || c > '9') return false;
+        value = value * 10 + (c - '0');
+    }
+    if(value > max) return false;
+
+    *out = (uint32_t)value;
+    return true;
+}
+
+size_t ir2hid_csv_split(char* line, IR2HIDCsvField* fields, size_t max_fields) {
+    size_t count = 0;
+    char* p = line;
+    char* start = line;
+
+    while(count < max_fields) {
+        if(*p == ',' || *p == '\0') {
+            const bool end = (*p == '\0');
+            *p = '\0';
+            fields[count].start = start;
+            fields[count].len = p - start;
+            count++;
+            if(end) break;
+            start = p + 1;
+        }
+        p++;
+    }
+    return count;
+}
+
+// --- Protocol Names ---
+
+// Protocol names resolved so far during a load. Rows of a real LUT almost always
+// repeat the same one or two protocols, so this turns the scan over every known
+// protocol name into a single string compare per row.
+#define IR2HID_PROTO_CACHE_SIZE 2
+#define IR2HID_PROTO_NAME_MAX 16
+
+typedef struct {
+    char name[IR2HID_PROTO_NAME_MAX];
+    InfraredProtocol protocol;
+} IR2HIDProtoCacheEntry;
+
+typedef struct {
+    IR2HIDProtoCacheEntry entries[IR2HID_PROTO_CACHE_SIZE]; // most recently used first
+} IR2HIDProtoCache;
+
+static void ir2hid_proto_cache_init(IR2HIDProtoCache* cache) {
+    for(size_t i = 0; i < IR2HID_PROTO_CACHE_SIZE; i++) {
+        cache->entries[i].name[0] = '\0';
+        cache->entries[i].protocol = InfraredProtocolUnknown;
+    }
+}
+
+static InfraredProtocol ir2hid_proto_cache_resolve(IR2HIDProtoCache* cache, const char* name) {
+    for(size_t i = 0; i < IR2HID_PROTO_CACHE_SIZE; i++) {
+        if(cache->entries[i].protocol != InfraredProtocolUnknown &&
+           strcmp(cache->entries[i].name, name) == 0) {
+            // Move to front
+            IR2HIDProtoCacheEntry hit = cache->entries[i];
+            memmove(&cache->entries[1], &cache->entries[0], i * sizeof(IR2HIDProtoCacheEntry));
+            cache->entries[0] = hit;
+            return hit.protocol;
+        }
+    }
+
+    InfraredProtocol proto = infrared_get_protocol_by_name(name);
+    if(infrared_is_protocol_valid(proto) && strlen(name) < IR2HID_PROTO_NAME_MAX) {
+        // Evict the least recently used
+        memmove(
+            &cache->entries[1],
+            &cache->entries[0],
+            (IR2HID_PROTO_CACHE_SIZE - 1) * sizeof(IR2HIDProtoCacheEntry));
+        strlcpy(cache->entries[0].name, name, IR2HID_PROTO_NAME_MAX);
+        cache->entries[0].protocol = proto;
+    }
+    return proto;
+}
+
+// --- String Pool ---
+
+// Comment strings live in a pool at the end of the LUT arena and are
+// referenced by 16-bit offsets. Identical strings are stored once, found through
+// a temporary hash of pool offsets that only exists while loading.
+typedef struct {
+    char* strings;
+    size_t size;
+    size_t capacity;
+    uint16_t* slots; // open addressing, IR2HID_LUT_NO_STRING marks an empty slot
+    size_t slot_mask;
+} IR2HIDStringPool;
+
+static uint32_t ir2hid_string_hash(const char* s, size_t len) {
+    // FNV-1a
+    uint32_t hash = 2166136261UL;
+    for(size_t i = 0; i < len; i++) {
+        hash = (hash ^ (uint8_t)s[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+static uint16_t ir2hid_string_pool_intern(IR2HIDStringPool* pool, const IR2HIDCsvField* field) {
+    if(field->len == 0) return IR2HID_LUT_NO_STRING;
+
+    size_t slot = ir2hid_string_hash(field->start, field->len) & pool->slot_mask;
+    while(pool->slots[slot] != IR2HID_LUT_NO_STRING) {
+        const char* s = &pool->strings[pool->slots[slot]];
+        if(strncmp(s, field->start, field->len) == 0 && s[field->len] == '\0') {
+            return pool->slots[slot];
+        }
+        slot = (slot + 1) & pool->slot_mask;
+    }
+
+    if(pool->size + field->len + 1 > pool->capacity) return IR2HID_LUT_NO_STRING;
+
+    uint16_t offset = (uint16_t)pool->size;
+    memcpy(&pool->strings[offset], field->start, field->len);
+    pool->strings[offset + field->len] = '\0';
+    pool->size += field->len + 1;
+    pool->slots[slot] = offset;
+    return offset;
+}
+
+// --- Action Table ---
+
+// Actions are stored once no matter how many rows map to them,
+// found through a temporary hash of action indexes while loading.
+// A cycle is followed by its steps and an IR transmit by its operands, either
+// only matches an identical list.
+typedef struct {
+    IR2HIDAction* actions;
+    size_t count;
+    uint16_t* slots; // open addressing, IR2HID_LUT_NO_ACTION marks an empty slot
+    size_t slot_mask;
+} IR2HIDActionTable;
+
+static bool ir2hid_action_equal(
+    const IR2HIDAction* a,
+    const IR2HIDAction* action,
+    const uint16_t* steps) {
+    if(a->type != action->type || a->code != action->code || a->count != action->count ||
+       a->cooldown != action->cooldown) {
+        return false;
+    }
+    for(size_t i = 0; i < action->count; i++) {
+        if(a[1 + i].code != steps[i]) return false;
+    }
+    return true;
+}
+
+// comment is only interned for a new action, rows sharing one keep its first comment
+static uint16_t ir2hid_action_table_intern(
+    IR2HIDActionTable* table,
+    const IR2HIDAction* action,
+    const uint16_t* steps,
+    IR2HIDStringPool* pool,
+    const IR2HIDCsvField* comment) {
+    uint32_t hash = (action->type * 31U) ^ (action->code * 2654435761UL) ^ action->cooldown;
+    for(size_t i = 0; i < action->count; i++) {
+        hash = (hash ^ steps[i]) * 16777619UL;
+    }
+
+    size_t slot = hash & table->slot_mask;
+    while(table->slots[slot] != IR2HID_LUT_NO_ACTION) {
+        if(ir2hid_action_equal(&table->actions[table->slots[slot]], action, steps)) {
+            return table->slots[slot];
+        }
+        slot = (slot + 1) & table->slot_mask;
+    }
+
+    const uint16_t index = table->count;
+    table->actions[table->count] = *action;
+    table->actions[table->count++].comment =
+        comment ? ir2hid_string_pool_intern(pool, comment) : IR2HID_LUT_NO_STRING;
+    for(size_t i = 0; i < action->count; i++) {
+        table->actions[table->count++] = (IR2HIDAction){
+            .type = action->type == IR2HIDActionTypeCycle ? IR2HIDActionTypeCycleStep :
+                                                            IR2HIDActionTypeOperand,
+            .code = steps[i],
+            .comment = IR2HID_LUT_NO_STRING,
+        };
+    }
+    table->slots[slot] = index;
+    return index;
+}
+
+bool ir2hid_lut_has_cycles(const IR2HIDAction* actions, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        if(actions[i].type == IR2HIDActionTypeCycle) return true;
+    }
+    return false;
+}
+
+bool ir2hid_lut_has_cooldowns(const IR2HIDAction* actions, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        if(actions[i].cooldown) return true;
+    }
+    return false;
+}
+
+// --- Row Parsing ---
+
+// hid_command: one code, or a cycle list like 0x7F|0xE2 sent in turn, one per press.
+// Keyboard usage in the low byte, optional KEY_MOD_* modifiers in the high byte.
+// Returns the number of codes, 0 if invalid.
+static size_t ir2hid_parse_hid_field(const IR2HIDCsvField* field, uint16_t* codes) {
+    const char* p = field->start;
+    const char* end = field->start + field->len;
+    size_t count = 0;
+
+    while(true) {
+        const char* sep = memchr(p, '|', end - p);
+        const IR2HIDCsvField part = {.start = p, .len = (sep ? sep : end) - p};
+        uint32_t code;
+        if(count == IR2HID_LUT_CYCLE_MAX || !ir2hid_parse_hex_field(&part, &code) ||
+           code > 0xFFFF || (code & 0xFF) == 0) {
+            return 0;
+        }
+        codes[count++] = (uint16_t)code;
+        if(!sep) return count;
+        p = sep + 1;
+    }
+}
+
+// hid_command: ir:<protocol>:<address>:<command> relays a different IR code instead,
+// e.g. ir:NEC:0x04:0x08. Fills the IrTransmit operands, false if invalid.
+static bool ir2hid_parse_ir_field(
+    const IR2HIDCsvField* field,
+    IR2HIDProtoCache* proto_cache,
+    uint16_t* operands) {
+    const char* p = field->start + 3; // after "ir:"
+    const char* end = field->start + field->len;
+
+    IR2HIDCsvField parts[3];
+    for(size_t i = 0; i < 3; i++) {
+        const char* sep = i < 2 ? memchr(p, ':', end - p) : end;
+        if(!sep) return false;
+        parts[i] = (IR2HIDCsvField){.start = p, .len = sep - p};
+        p = sep + 1;
+    }
+
+    // The resolver wants a NUL-terminated name
+    char name[IR2HID_PROTO_NAME_MAX];
+    if(parts[0].len == 0 || parts[0].len >= sizeof(name)) return false;
+    memcpy(name, parts[0].start, parts[0].len);
+    name[parts[0].len] = '\0';
+    const InfraredProtocol proto = ir2hid_proto_cache_resolve(proto_cache, name);
+    if(!infrared_is_protocol_valid(proto)) return false;
+
+    uint32_t addr;
+    uint32_t cmd;
+    if(!ir2hid_parse_hex_field(&parts[1], &addr) || !ir2hid_parse_hex_field(&parts[2], &cmd)) {
+        return false;
+    }
+
+    operands[0] = (uint16_t)proto;
+    operands[1] = (uint16_t)addr;
+    operands[2] = (uint16_t)(addr >> 16);
+    operands[3] = (uint16_t)cmd;
+    operands[4] = (uint16_t)(cmd >> 16);
+    return true;
+}
+
+// The firmware's HID descriptor has no Generic Desktop system control collection,
+// hosts handle these Consumer page usages as the power button and sleep key instead
+const IR2HIDSystemUsage ir2hid_system_usages[] = {
+    {"power", HID_CONSUMER_POWER},
+    {"sleep", HID_CONSUMER_SLEEP},
+};
+const size_t ir2hid_system_usage_count = COUNT_OF(ir2hid_system_usages);
+
+// hid_command: sys:<name>, 0 if the name is unknown
+static uint16_t ir2hid_parse_system_field(const IR2HIDCsvField* field) {
+    const char* name = field->start + 4; // after "sys:"
+    const size_t len = field->len - 4;
+    for(size_t i = 0; i < ir2hid_system_usage_count; i++) {
+        if(strlen(ir2hid_system_usages[i].name) == len &&
+           strncmp(ir2hid_system_usages[i].name, name, len) == 0) {
+            return ir2hid_system_usages[i].usage;
+        }
+    }
+    return 0;
+}
+
+// hid_command: text:<UTF-8 text> types the text, interned into the string pool
+static uint16_t ir2hid_parse_text_field(const IR2HIDCsvField* field, IR2HIDStringPool* pool) {
+    const IR2HIDCsvField text = {.start = field->start + 5, .len = field->len - 5};
+    if(text.len == 0 || text.len > IR2HID_LUT_TEXT_MAX) return IR2HID_LUT_NO_STRING;
+    return ir2hid_string_pool_intern(pool, &text);
+}
+
+static bool ir2hid_parse_lut_line(
+    char* line,
+    IR2HIDKey* key,
+    IR2HIDLutRow* row,
+    IR2HIDProtoCache* proto_cache,
+    IR2HIDStringPool* pool,
+    IR2HIDActionTable* actions) {
+    // Expected CSV:
+    // ir_protocol,ir_address,ir_command,hid_command,ir_key_comment,hid_key_comment,cooldown_ms
+    const size_t MinColumns = 4; // comments in col 5-6 and the cooldown in col 7 are optional
+    const size_t MaxColumns = 7;
+    IR2HIDCsvField cols[7];
+
+    const size_t col_count = ir2hid_csv_split(line, cols, MaxColumns);
+    if(col_count < MinColumns) return false;
+
+    // Protocol
+    InfraredProtocol proto = ir2hid_proto_cache_resolve(proto_cache, cols[0].start);
+    if(!infrared_is_protocol_valid(proto)) return false;
+
+    uint32_t addr_val = 0;
+    uint32_t cmd_val = 0;
+    uint16_t codes[MAX(IR2HID_LUT_CYCLE_MAX, IR2HID_LUT_IR_OPERANDS)];
+
+    if(!ir2hid_parse_hex_field(&cols[1], &addr_val)) return false;
+    if(!ir2hid_parse_hex_field(&cols[2], &cmd_val)) return false;
+    if(cmd_val > IR2HID_KEY_COMMAND_MAX) return false;
+
+    // Empty is the same as no cooldown
+    uint32_t cooldown = 0;
+    if(col_count > 6 && cols[6].len > 0 &&
+       !ir2hid_parse_dec_field(&cols[6], IR2HID_LUT_COOLDOWN_MAX, &cooldown)) {
+        return false;
+    }
+
+    IR2HIDAction action = {
+        .comment = IR2HID_LUT_NO_STRING, // set once the action turns out to be new
+        .cooldown = (uint16_t)cooldown,
+    };
+    if(cols[3].len > 3 && strncmp(cols[3].start, "ir:", 3) == 0) {
+        if(!ir2hid_parse_ir_field(&cols[3], proto_cache, codes)) return false;
+        action.type = IR2HIDActionTypeIrTransmit;
+        action.count = IR2HID_LUT_IR_OPERANDS;
+    } else if(cols[3].len > 5 && strncmp(cols[3].start, "text:", 5) == 0) {
+        action.type = IR2HIDActionTypeText;
+        action.code = ir2hid_parse_text_field(&cols[3], pool);
+        if(action.code == IR2HID_LUT_NO_STRING) return false;
+    } else if(cols[3].len > 4 && strncmp(cols[3].start, "sys:", 4) == 0) {
+        action.type = IR2HIDActionTypeSystem;
+        action.code = ir2hid_parse_system_field(&cols[3]);
+        if(action.code == 0) return false;
+    } else {
+        const size_t code_count = ir2hid_parse_hid_field(&cols[3], codes);
+        if(code_count == 0) return false;
+        const bool cycle = code_count > 1;
+        action.type = cycle ? IR2HIDActionTypeCycle : IR2HIDActionTypeKeyboard;
+        action.count = cycle ? code_count : 0;
+        action.code = cycle ? 0 : codes[0];
+    }
+
+    *key = ir2hid_key_pack(proto, addr_val, cmd_val);
+    row->action = ir2hid_action_table_intern(
+        actions, &action, codes, pool, col_count > 5 ? &cols[5] : NULL);
+    row->ir_comment =
+        col_count > 4 ? ir2hid_string_pool_intern(pool, &cols[4]) : IR2HID_LUT_NO_STRING;
+
+    return true;
+}
+
+bool ir2hid_key_from_message(const InfraredMessage* msg, IR2HIDKey* key) {
+    if(msg->command > IR2HID_KEY_COMMAND_MAX) return false;
+    *key = ir2hid_key_pack(msg->protocol, msg->address, msg->command);
+    return true;
+}
+
+// --- Sorting & Deduplication ---
+
+// Keys and rows are sorted as the parallel arrays they end up in. By key, then
+// by line, so of rows with the same key the first one in the file comes first.
+static inline bool ir2hid_lut_row_before(
+    const IR2HIDKey* keys,
+    const IR2HIDLutRow* rows,
+    size_t a,
+    size_t b) {
+    return keys[a] != keys[b] ? keys[a] < keys[b] : rows[a].line < rows[b].line;
+}
+
+static inline void ir2hid_lut_row_swap(IR2HIDKey* keys, IR2HIDLutRow* rows, size_t a, size_t b) {
+    const IR2HIDKey key = keys[a];
+    const IR2HIDLutRow row = rows[a];
+    keys[a] = keys[b];
+    rows[a] = rows[b];
+    keys[b] = key;
+    rows[b] = row;
+}
+
+static void ir2hid_lut_sift_down(IR2HIDKey* keys, IR2HIDLutRow* rows, size_t root, size_t end) {
+    while(root * 2 + 1 < end) {
+        size_t child = root * 2 + 1;
+        if(child + 1 < end && ir2hid_lut_row_before(keys, rows, child, child + 1)) child++;
+        if(!ir2hid_lut_row_before(keys, rows, root, child)) return;
+        ir2hid_lut_row_swap(keys, rows, root, child);
+        root = child;
+    }
+}
+
+// Heapsort, O(n log n) in place without a scratch copy
+static void ir2hid_lut_sort(IR2HIDKey* keys, IR2HIDLutRow* rows, size_t count) {
+    for(size_t i = count / 2; i-- > 0;) {
+        ir2hid_lut_sift_down(keys, rows, i, count);
+    }
+    for(size_t end = count; end-- > 1;) {
+        ir2hid_lut_row_swap(keys, rows, 0, end);
+        ir2hid_lut_sift_down(keys, rows, 0, end);
+    }
+}
+
+// Sort, then compact equal keys in place keeping the earliest row.
+// Returns the number of rows left.
+static size_t ir2hid_lut_sort_unique(
+    IR2HIDLut* lut,
+    IR2HIDKey* keys,
+    IR2HIDLutRow* rows,
+    size_t count,
+    const IR2HIDAction* actions,
+    const char* strings,
+    IR2HIDLutIssueCallback issue_callback,
+    void* context) {
+    if(count == 0) return 0;
+
+    ir2hid_lut_sort(keys, rows, count);
+
+    size_t out = 1;
+    for(size_t i = 1; i < count; i++) {
+        const IR2HIDLutRow* kept = &rows[out - 1];
+        const IR2HIDLutRow* r = &rows[i];
+
+        if(keys[i] != keys[out - 1]) {
+            keys[out] = keys[i];
+            rows[out++] = *r;
+            continue;
+        }
+
+        // Actions are deduplicated, the same index means the same mapping
+        if(r->action == kept->action) {
+            lut->duplicates++;
+        } else {
+            lut->conflicts++;
+        }
+        if(lut->first_issue_line == 0 || r->line < lut->first_issue_line) {
+            lut->first_issue_line = r->line;
+            lut->first_issue_kept_line = kept->line;
+        }
+        if(issue_callback) {
+            IR2HIDLutIssue issue = {
+                .key = keys[i],
+                .line = r->line,
+                .kept_line = kept->line,
+                .action = &actions[r->action],
+                .kept_action = &actions[kept->action],
+                .strings = strings,
+            };
+            issue_callback(context, &issue);
+        }
+    }
+    return out;
+}
+
+// --- LUT Loading ---
+
+bool ir2hid_lut_parse(
+    IR2HIDLut* lut,
+    char* buf,
+    size_t len,
+    IR2HIDLutIssueCallback issue_callback,
+    void* context) {
+    memset(lut, 0, sizeof(IR2HIDLut));
+    ir2hid_lut_settings_default(&lut->settings);
+    const uint32_t load_start = DWT->CYCCNT;
+
+    // First pass: bound what the rows can need, so the arena is allocated once and
+    // built in place. A data row has at least 3 commas. Its actions and strings all
+    // come from the columns behind the third comma: one action plus one per cycle
+    // step or IR operand, and at most all of those characters as strings.
+    size_t max_rows = 0;
+    size_t max_actions = 0;
+    size_t max_strings = 0;
+    bool maybe_cooldowns = false;
+    bool maybe_cycles = false;
+    size_t commas = 0;
+    size_t pipes = 0;
+    size_t colons = 0;
+    for(size_t i = 0; i <= len; i++) {
+        const char c = buf[i];
+        if(c == '\r' || c == '\n' || c == '\0') {
+            if(commas >= 3) {
+                max_rows++;
+                max_actions += 1 + (pipes ? pipes + 1 : 0) + (colons ? IR2HID_LUT_IR_OPERANDS : 0);
+                max_strings += 3; // NULs of the text, the IR comment and the HID comment
+            }
+            maybe_cycles |= pipes > 0;
+            commas = pipes = colons = 0;
+        } else if(c == ',') {
+            commas++;
+            if(commas == 6) maybe_cooldowns = true;
+        } else if(commas >= 3) {
+            max_strings++;
+            if(c == '|') pipes++;
+            if(c == ':') colons++;
+        }
+    }
+    if(max_rows == 0) return false;
+    if(max_actions >= IR2HID_LUT_NO_ACTION) return false;
+    const size_t pool_capacity = MIN(max_strings, (size_t)IR2HID_LUT_NO_STRING);
+
+    // One arena in the final order, with room for the bounds while parsing:
+    // keys, fire ticks, rows, actions, strings, cycle states. Whatever is left
+    // over moves down once the counts are known, then the tail is given back.
+    const size_t keys_max = sizeof(IR2HIDKey) * max_rows;
+    const size_t fired_max = maybe_cooldowns ? sizeof(uint32_t) * max_rows : 0;
+    const size_t rows_max = sizeof(IR2HIDLutRow) * max_rows;
+    const size_t actions_max = sizeof(IR2HIDAction) * max_actions;
+    const size_t states_max = maybe_cycles ? max_rows : 0;
+    uint8_t* arena = malloc(keys_max + fired_max + rows_max + actions_max + pool_capacity + states_max);
+    if(!arena) return false;
+
+    IR2HIDKey* keys = (IR2HIDKey*)arena;
+    IR2HIDLutRow* rows = (IR2HIDLutRow*)(arena + keys_max + fired_max);
+    IR2HIDActionTable actions = {
+        .actions = (IR2HIDAction*)((uint8_t*)rows + rows_max),
+        .count = 0,
+    };
+    IR2HIDStringPool pool = {
+        .strings = (char*)actions.actions + actions_max,
+        .size = 0,
+        .capacity = pool_capacity,
+    };
+
+    // Both hash tables in one block, only while parsing, at most half full. A row
+    // interns up to three strings (text, IR and HID comment) of at least one
+    // character and its NUL, and one action.
+    const size_t string_count = MIN(max_rows * 3, pool_capacity / 2);
+    size_t string_slots = 16;
+    while(string_slots < string_count * 2) string_slots <<= 1;
+    size_t action_slots = 16;
+    while(action_slots < max_rows * 2) action_slots <<= 1;
+    const size_t slots_size = (string_slots + action_slots) * sizeof(uint16_t);
+    uint16_t* slots = malloc(slots_size);
+    if(!slots) {
+        // Without them nothing would be deduplicated and every comment dropped
+        FURI_LOG_E(TAG, "No RAM for the LUT hash tables, %zu bytes", slots_size);
+        free(arena);
+        return false;
+    }
+    memset(slots, 0xFF, slots_size);
+    pool.slots = slots;
+    pool.slot_mask = string_slots - 1;
+    actions.slots = slots + string_slots;
+    actions.slot_mask = action_slots - 1;
+
+    // Second pass: split lines in place and parse every data line (skip header)
+    IR2HIDProtoCache proto_cache;
+    ir2hid_proto_cache_init(&proto_cache);
+    size_t count = 0;
+    uint16_t line_no = 0;
+    bool header = true;
+    char* line_start = buf;
+
+    for(size_t i = 0; i <= len; i++) {
+        char c = buf[i];
+        if(c == '\r' || c == '\n' || c == '\0') {
+            buf[i] = '\0';
+            line_no++;
+            // CRLF is a single line break
+            if(c == '\r' && i < len && buf[i + 1] == '\n') i++;
+
+            if(line_start[0] == '@') {
+                ir2hid_lut_apply_settings(lut, line_start);
+            } else if(line_start[0] != '\0') {
+                if(header) {
+                    header = false;
+                } else if(ir2hid_parse_lut_line(
+                              line_start,
+                              &keys[count],
+                              &rows[count],
+                              &proto_cache,
+                              &pool,
+                              &actions)) {
+                    rows[count].line = line_no;
+                    count++;
+                }
+            }
+            line_start = &buf[i + 1];
+        }
+    }
+
+    free(slots);
+
+    const uint32_t build_start = DWT->CYCCNT;
+    count = ir2hid_lut_sort_unique(
+        lut, keys, rows, count, actions.actions, pool.strings, issue_callback, context);
+    if(count == 0) {
+        free(arena);
+        return false;
+    }
+
+    // Close the gaps left by the bounds: dense sorted keys for the search, the fire
+    // ticks (4 byte aligned behind the keys), the row data parallel to them, then
+    // the shared actions, the strings and the cycle states. Every part only moves down.
+    const size_t keys_size = sizeof(IR2HIDKey) * count;
+    const size_t fired_size =
+        ir2hid_lut_has_cooldowns(actions.actions, actions.count) ? sizeof(uint32_t) * count : 0;
+    const size_t rows_size = sizeof(IR2HIDLutRow) * count;
+    const size_t actions_size = sizeof(IR2HIDAction) * actions.count;
+    const size_t states_size = ir2hid_lut_has_cycles(actions.actions, actions.count) ? count : 0;
+
+    uint8_t* rows_start = arena + keys_size + fired_size;
+    memmove(rows_start, rows, rows_size);
+    memmove(rows_start + rows_size, actions.actions, actions_size);
+    memmove(rows_start + rows_size + actions_size, pool.strings, pool.size);
+
+    // Only a shrink, if that fails the arena keeps its tail
+    uint8_t* shrunk = realloc(
+        arena, keys_size + fired_size + rows_size + actions_size + pool.size + states_size);
+    if(shrunk) {
+        arena = shrunk;
+        keys = (IR2HIDKey*)arena;
+        rows_start = arena + keys_size + fired_size;
+    }
+
+    lut->arena = arena;
+    lut->keys = keys;
+    if(fired_size) {
+        lut->fired = (uint32_t*)(arena + keys_size);
+        memset(lut->fired, 0, fired_size);
+    }
+    lut->rows = (IR2HIDLutRow*)rows_start;
+    lut->count = count;
+    lut->actions = (IR2HIDAction*)(rows_start + rows_size);
+    lut->action_count = actions.count;
+    lut->strings = (const char*)(rows_start + rows_size + actions_size);
+    lut->strings_size = pool.size;
+    if(states_size) {
+        lut->states = rows_start + rows_size + actions_size + pool.size;
+        memset(lut->states, 0, states_size);
+    }
+
+    const uint32_t end = DWT->CYCCNT;
+    lut->load_cycles = end - load_start;
+    lut->build_cycles = end - build_start;
+    return true;
+}
+
+typedef struct {
+    Storage* storage;
+    File* log;
+} IR2HIDLutLog;
+
+// hid_command as it would be written in lut.csv
+static void ir2hid_lut_log_format_action(
+    const IR2HIDAction* action,
+    const char* strings,
+    char* out,
+    size_t out_size) {
+    switch(action->type) {
+    case IR2HIDActionTypeCycle: {
+        size_t len = 0;
+        for(size_t i = 0; i < action->count && len < out_size; i++) {
+            len += snprintf(
+                out + len, out_size - len, "%s0x%02X", i ? "|" : "", action[1 + i].code);
+        }
+        break;
+    }
+    case IR2HIDActionTypeIrTransmit: {
+        const char* name = infrared_get_protocol_name(action[1].code);
+        snprintf(
+            out,
+            out_size,
+            "ir:%s:0x%lX:0x%lX",
+            name ? name : "?",
+            action[2].code | ((uint32_t)action[3].code << 16),
+            action[4].code | ((uint32_t)action[5].code << 16));
+        break;
+    }
+    case IR2HIDActionTypeText:
+        snprintf(out, out_size, "text:%s", &strings[action->code]);
+        break;
+    case IR2HIDActionTypeSystem: {
+        const char* name = "?";
+        for(size_t i = 0; i < ir2hid_system_usage_count; i++) {
+            if(ir2hid_system_usages[i].usage == action->code) name = ir2hid_system_usages[i].name;
+        }
+        snprintf(out, out_size, "sys:%s", name);
+        break;
+    }
+    default:
+        snprintf(out, out_size, "0x%02X", action->code);
+        break;
+    }
+}
+
+static void ir2hid_lut_log_issue(void* context, const IR2HIDLutIssue* issue) {
+    IR2HIDLutLog* log = context;
+
+    // Only create the log file once there is something to report
+    if(!log->log) {
+        log->log = storage_file_alloc(log->storage);
+        if(!storage_file_open(log->log, IR2HID_LUT_LOG_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+            storage_file_free(log->log);
+            log->log = NULL;
+            return;
+        }
+    }
+
+    const char* name = infrared_get_protocol_name(ir2hid_key_protocol(issue->key));
+    char text[256];
+    int text_len;
+    if(issue->action == issue->kept_action) {
+        text_len = snprintf(
+            text,
+            sizeof(text),
+            "line %u: duplicate of line %u (%s 0x%04lX 0x%04lX)\n",
+            issue->line,
+            issue->kept_line,
+            name ? name : "?",
+            ir2hid_key_address(issue->key),
+            ir2hid_key_command(issue->key));
+    } else {
+        char ignored[IR2HID_LUT_TEXT_MAX + 8];
+        char used[IR2HID_LUT_TEXT_MAX + 8];
+        ir2hid_lut_log_format_action(issue->action, issue->strings, ignored, sizeof(ignored));
+        ir2hid_lut_log_format_action(issue->kept_action, issue->strings, used, sizeof(used));
+        text_len = snprintf(
+            text,
+            sizeof(text),
+            "line %u: conflicts with line %u (%s 0x%04lX 0x%04lX): %s ignored, %s used\n",
+            issue->line,
+            issue->kept_line,
+            name ? name : "?",
+            ir2hid_key_address(issue->key),
+            ir2hid_key_command(issue->key),
+            ignored,
+            used);
+    }
+    if(text_len > 0) {
+        storage_file_write(log->log, text, MIN((size_t)text_len, sizeof(text) - 1));
+    }
+}
+
+static IR2HIDLutStatus ir2hid_lut_load_csv(IR2HIDLut* lut) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+
+    if(!storage_file_open(file, IR2HID_LUT_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        storage_file_free(file);
+        furi_record_close(RECORD_STORAGE);
+        return IR2HIDLutStatusNotFound;
+    }
+
+    // Get file size and allocate buffer
+    uint64_t file_size = storage_file_size(file);
+    char* buf = NULL;
+    if(file_size > 0 && file_size <= IR2HID_LUT_MAX_FILE_SIZE) {
+        buf = malloc((size_t)file_size + 1);
+    }
+    if(!buf) {
+        storage_file_close(file);
+        storage_file_free(file);
+        furi_record_close(RECORD_STORAGE);
+        return IR2HIDLutStatusInvalid;
+    }
+
+    size_t read = storage_file_read(file, buf, (size_t)file_size);
+    buf[read] = '\0';
+
+    storage_file_close(file);
+    storage_file_free(file);
+
+    IR2HIDLutLog log = {.storage = storage, .log = NULL};
+    bool parsed = ir2hid_lut_parse(lut, buf, read, ir2hid_lut_log_issue, &log);
+
+    if(log.log) {
+        storage_file_close(log.log);
+        storage_file_free(log.log);
+    } else {
+        // Clean LUT, don't leave a stale report around
+        storage_simply_remove(storage, IR2HID_LUT_LOG_PATH);
+    }
+    furi_record_close(RECORD_STORAGE);
+
+    // Free the file buffer (we've parsed everything we need)
+    free(buf);
+
+    return parsed ? IR2HIDLutStatusOk : IR2HIDLutStatusInvalid;
+}
+
+// --- Cycle State ---
+
+// lut.state holds a record for every row that isn't on its first step. Rows are
+// found again by key, so edits to the LUT don't shift the positions.
+typedef struct {
+    IR2HIDKey key;
+    uint8_t state;
+    uint8_t reserved[7];
+} IR2HIDLutStateRecord;
+
+static void ir2hid_lut_load_state(IR2HIDLut* lut) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+
+    if(storage_file_open(file, IR2HID_LUT_STATE_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        IR2HIDLutStateRecord record;
+        while(storage_file_read(file, &record, sizeof(record)) == sizeof(record)) {
+            IR2HIDLutRow row;
+            uint32_t index;
+            if(!ir2hid_lut_lookup(lut, record.key, &row, &index)) continue;
+            const IR2HIDAction* action = &lut->actions[row.action];
+            if(action->type == IR2HIDActionTypeCycle && record.state < action->count) {
+                lut->states[index] = record.state;
+            }
+        }
+        storage_file_close(file);
+    }
+
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+void ir2hid_lut_save_state(IR2HIDLut* lut) {
+    if(!lut->states || !lut->states_dirty) return;
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+
+    if(storage_file_open(file, IR2HID_LUT_STATE_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        for(size_t i = 0; i < lut->count; i++) {
+            if(lut->states[i] == 0) continue;
+            IR2HIDLutStateRecord record = {.state = lut->states[i]};
+            if(lut->pages) {
+                if(!ir2hid_lut_pages_key(lut, i, &record.key)) continue;
+            } else {
+                record.key = lut->keys[i];
+            }
+            storage_file_write(file, &record, sizeof(record));
+        }
+        storage_file_close(file);
+        lut->states_dirty = false;
+    }
+
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+uint16_t ir2hid_lut_press(IR2HIDLut* lut, const IR2HIDLutRow* row, uint32_t index) {
+    const IR2HIDAction* action = &lut->actions[row->action];
+    if(action->type != IR2HIDActionTypeCycle) return action->code;
+
+    // Steps follow the cycle, a broken lut.bin can't point past the table
+    if(!lut->states || action->count == 0 || row->action + action->count >= lut->action_count) {
+        return 0;
+    }
+
+    uint8_t* state = &lut->states[index];
+    const uint16_t code = action[1 + *state % action->count].code;
+    *state = (*state + 1) % action->count;
+    lut->states_dirty = true;
+    return code;
+}
+
+// --- Settings ---
+
+typedef struct {
+    const char* key;
+    size_t offset; // of the uint16_t in IR2HIDLutSettings
+    uint16_t min;
+    uint16_t max;
+} IR2HIDLutNumericSetting;
+
+static const IR2HIDLutNumericSetting ir2hid_lut_numeric_settings[] = {
+    {"event_queue", offsetof(IR2HIDLutSettings, event_queue), 4, 64},
+    {"debounce_ms", offsetof(IR2HIDLutSettings, debounce_ms), 0, 1000},
+    {"min_press_ms", offsetof(IR2HIDLutSettings, min_press_ms), 1, 1000},
+    {"redraw_ms", offsetof(IR2HIDLutSettings, redraw_ms), 0, 1000},
+    {"repeat_delay_ms", offsetof(IR2HIDLutSettings, repeat_delay_ms), 0, 5000},
+    {"repeat_ms", offsetof(IR2HIDLutSettings, repeat_ms), 10, 5000},
+};
+
+void ir2hid_lut_settings_default(IR2HIDLutSettings* settings) {
+    settings->layout = IR2HIDLayoutUS;
+    settings->early_nec = false;
+    settings->dispatch_thread = true;
+    settings->event_queue = 8;
+    settings->debounce_ms = 5;
+    settings->min_press_ms = IR2HID_HID_MIN_PRESS_MS;
+    settings->redraw_ms = 50;
+    settings->repeat_delay_ms = 0;
+    settings->repeat_ms = 100;
+}
+
+static bool ir2hid_lut_apply_setting(IR2HIDLutSettings* settings, const char* key, const char* value) {
+    if(strcmp(key, "layout") == 0) {
+        for(size_t i = 0; i < IR2HIDLayoutCount; i++) {
+            if(strcmp(value, ir2hid_layout_names[i]) == 0) {
+                settings->layout = (IR2HIDLayout)i;
+                return true;
+            }
+        }
+        return false;
+    } else if(strcmp(key, "early_nec") == 0) {
+        if(strcmp(value, "on") != 0 && strcmp(value, "off") != 0) return false;
+        settings->early_nec = value[1] == 'n';
+        return true;
+    } else if(strcmp(key, "dispatch") == 0) {
+        if(strcmp(value, "thread") != 0 && strcmp(value, "loop") != 0) return false;
+        settings->dispatch_thread = value[0] == 't';
+        return true;
+    }
+
+    for(size_t i = 0; i < COUNT_OF(ir2hid_lut_numeric_settings); i++) {
+        const IR2HIDLutNumericSetting* numeric = &ir2hid_lut_numeric_settings[i];
+        if(strcmp(key, numeric->key) != 0) continue;
+
+        const IR2HIDCsvField field = {.start = value, .len = strlen(value)};
+        uint32_t number;
+        if(!ir2hid_parse_dec_field(&field, numeric->max, &number) || number < numeric->min) {
+            return false;
+        }
+        *(uint16_t*)((uint8_t*)settings + numeric->offset) = (uint16_t)number;
+        return true;
+    }
+    return false;
+}
+
+void ir2hid_lut_apply_settings(IR2HIDLut* lut, char* text) {
+    char* line = text;
+    while(line && *line) {
+        char* next = strchr(line, '\n');
+        if(next) *next++ = '\0';
+
+        if(line[0] == '@') line++;
+        char* value = strchr(line, ',');
+        if(value) {
+            *value++ = '\0';
+            // Trailing columns, e.g. from a spreadsheet export
+            char* end = strchr(value, ',');
+            if(end) *end = '\0';
+            if(!ir2hid_lut_apply_setting(&lut->settings, line, value)) {
+                FURI_LOG_W(TAG, "Ignored @%s,%s", line, value);
+            }
+        }
+        line = next;
+    }
+}
+
+bool ir2hid_lut_cooling_down(
+    const IR2HIDLut* lut,
+    const IR2HIDLutRow* row,
+    uint32_t index,
+    uint32_t now) {
+    const IR2HIDAction* action = &lut->actions[row->action];
+    if(action->cooldown == 0 || !lut->fired) return false;
+
+    const uint32_t fired = lut->fired[index];
+    return fired != 0 && now - fired < furi_ms_to_ticks(action->cooldown);
+}
+
+void ir2hid_lut_fire(IR2HIDLut* lut, const IR2HIDLutRow* row, uint32_t index, uint32_t now) {
+    if(lut->actions[row->action].cooldown == 0 || !lut->fired) return;
+    lut->fired[index] = now ? now : 1; // 0 means never fired
+}
+
+bool ir2hid_lut_ir_message(
+    const IR2HIDLut* lut,
+    const IR2HIDLutRow* row,
+    InfraredMessage* message) {
+    const IR2HIDAction* action = &lut->actions[row->action];
+    if(action->type != IR2HIDActionTypeIrTransmit || action->count != IR2HID_LUT_IR_OPERANDS ||
+       row->action + action->count >= lut->action_count) {
+        return false;
+    }
+
+    // lut.bin stores an index into its protocol table like it does for keys
+    const IR2HIDAction* operands = action + 1;
+    InfraredProtocol proto = (InfraredProtocol)operands[0].code;
+    if(lut->pages) proto = ir2hid_lut_pages_protocol(lut, (uint8_t)operands[0].code);
+    if(!infrared_is_protocol_valid(proto)) return false;
+
+    message->protocol = proto;
+    message->address = operands[1].code | ((uint32_t)operands[2].code << 16);
+    message->command = operands[3].code | ((uint32_t)operands[4].code << 16);
+    message->repeat = false;
+    return true;
+}
+
+IR2HIDLutStatus ir2hid_lut_load(IR2HIDLut* lut) {
+    memset(lut, 0, sizeof(IR2HIDLut));
+    ir2hid_lut_settings_default(&lut->settings);
+
+    // A prebuilt lut.bin takes precedence, it's how tables larger than RAM are loaded
+    IR2HIDLutStatus status = ir2hid_lut_pages_load(lut, IR2HID_LUT_BIN_PATH);
+    if(status == IR2HIDLutStatusNotFound) status = ir2hid_lut_load_csv(lut);
+
+    if(status == IR2HIDLutStatusOk && lut->states) ir2hid_lut_load_state(lut);
+    return status;
+}
+
+void ir2hid_lut_free(IR2HIDLut* lut) {
+    ir2hid_lut_pages_free(lut);
+    if(lut->arena) {
+        free(lut->arena);
+    }
+    memset(lut, 0, sizeof(IR2HIDLut));
+}
+
+void ir2hid_lut_format_signal(
+    const IR2HIDLut* lut,
+    const InfraredMessage* msg,
+    const IR2HIDLutRow* row,
+    IR2HIDSignalText* text) {
+    const char* name = NULL;
+    if(infrared_is_protocol_valid(msg->protocol)) {
+        name = infrared_get_protocol_name(msg->protocol);
+    }
+    if(!name) name = "Unknown";
+
+    snprintf(text->proto, sizeof(text->proto), "Proto: %s", name);
+    snprintf(text->addr, sizeof(text->addr), "Addr: 0x%04lX", msg->address);
+    text->comment[0] = '\0';
+
+    if(!row) {
+        snprintf(text->cmd, sizeof(text->cmd), "Cmd:0x%04lX (no map)", msg->command);
+        return;
+    }
+
+    const IR2HIDAction* action = &lut->actions[row->action];
+    InfraredMessage relay;
+    if(action->type == IR2HIDActionTypeCycle) {
+        snprintf(text->cmd, sizeof(text->cmd), "Cmd:0x%04lX cycle of %u", msg->command, action->count);
+    } else if(ir2hid_lut_ir_message(lut, row, &relay)) {
+        snprintf(text->cmd, sizeof(text->cmd), "Cmd:0x%04lX IR:0x%04lX", msg->command, relay.command);
+    } else if(action->type == IR2HIDActionTypeText) {
+        snprintf(
+            text->cmd,
+            sizeof(text->cmd),
+            "Cmd:0x%04lX text %s",
+            msg->command,
+            ir2hid_layout_names[lut->settings.layout]);
+    } else if(action->type == IR2HIDActionTypeSystem) {
+        const char* name = "?";
+        for(size_t i = 0; i < ir2hid_system_usage_count; i++) {
+            if(ir2hid_system_usages[i].usage == action->code) name = ir2hid_system_usages[i].name;
+        }
+        snprintf(text->cmd, sizeof(text->cmd), "Cmd:0x%04lX sys %s", msg->command, name);
+    } else {
+        snprintf(text->cmd, sizeof(text->cmd), "Cmd:0x%04lX HID:0x%02X", msg->command, action->code);
+    }
+
+    // e.g. "remote vol+ > KEY_MEDIA_VOLUME_UP"
+    const char* ir_comment = ir2hid_lut_comment(lut, row->ir_comment);
+    const char* hid_comment = ir2hid_lut_comment(lut, action->comment);
+    if(ir_comment || hid_comment) {
+        snprintf(
+            text->comment,
+            sizeof(text->comment),
+            "%s > %s",
+            ir_comment ? ir_comment : "?",
+            hid_comment ? hid_comment : "?");
+    }
+}
+
+const char* ir2hid_lut_comment(const IR2HIDLut* lut, uint16_t offset) {
+    // Offsets in lut.bin aren't trusted
+    if(offset == IR2HID_LUT_NO_STRING || offset >= lut->strings_size) return NULL;
+    return &lut->strings[offset];
+}
+
+bool ir2hid_lut_lookup(const IR2HIDLut* lut, IR2HIDKey key, IR2HIDLutRow* row, uint32_t* index) {
+    if(lut->pages) return ir2hid_lut_pages_find(lut, key, row, index);
+
+    size_t found;
+    if(!ir2hid_lut_find(lut, key, &found)) return false;
+    *row = lut->rows[found];
+    *index = found;
+    return true;
+}
+
+// First row with a key not below key
+static size_t ir2hid_lut_lower_bound(const IR2HIDLut* lut, IR2HIDKey key) {
+    size_t lo = 0;
+    size_t hi = lut->count;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(lut->keys[mid] < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+size_t ir2hid_lut_match_prefix(
+    const IR2HIDLut* lut,
+    IR2HIDKey key,
+    uint32_t command_mask,
+    IR2HIDKey* match) {
+    // Protocol and address sort first, the rows of one address are a range
+    const IR2HIDKey base = key & ~(IR2HIDKey)IR2HID_KEY_COMMAND_MAX;
+    uint32_t index;
+    if(lut->pages) {
+        if(!ir2hid_lut_pages_lower_bound(lut, base, &index)) return 0;
+    } else {
+        index = ir2hid_lut_lower_bound(lut, base);
+    }
+
+    size_t count = 0;
+    for(; index < lut->count && count < 2; index++) {
+        IR2HIDKey k = 0;
+        if(lut->pages) {
+            if(!ir2hid_lut_pages_key(lut, index, &k)) break;
+        } else {
+            k = lut->keys[index];
+        }
+        if((k & ~(IR2HIDKey)IR2HID_KEY_COMMAND_MAX) != base) break;
+
+        if(((k ^ key) & command_mask) == 0) {
+            if(count == 0) *match = k;
+            count++;
+        }
+    }
+    return count;
+}
+
+bool ir2hid_lut_find(const IR2HIDLut* lut, IR2HIDKey key, size_t* index) {
+    size_t lo = 0;
+    size_t hi = lut->count;
+
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const IR2HIDKey k = lut->keys[mid];
+        if(k == key) {
+            *index = mid;
+            return true;
+        }
+        if(k < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <furi.h>
+#include <infrared.h>
+
+#include "ir2hid_layouts.h"
+
+// Path for `lut.csv` on the SD card: /ext/apps_data/ir2hid/lut.csv
+#define IR2HID_LUT_PATH EXT_PATH("apps_data/ir2hid/lut.csv")
+// Binary LUT built by tools/lut2bin.py, used instead of lut.csv when present.
+// Only a page directory and a few pages are kept in RAM.
+#define IR2HID_LUT_BIN_PATH EXT_PATH("apps_data/ir2hid/lut.bin")
+// Cycle positions of stateful rows, written on exit
+#define IR2HID_LUT_STATE_PATH EXT_PATH("apps_data/ir2hid/lut.state")
+// Duplicate and conflicting rows found while loading are reported here
+#define IR2HID_LUT_LOG_PATH EXT_PATH("apps_data/ir2hid/lut.log")
+
+// Sanity check: max LUT file size
+#define IR2HID_LUT_MAX_FILE_SIZE 8192
+
+// (protocol, address, command) packed so that sorting by key sorts by protocol,
+// then address, then command: protocol:8 | address:32 | command:24
+typedef uint64_t IR2HIDKey;
+
+#define IR2HID_KEY_COMMAND_MAX 0xFFFFFFUL
+
+// String pool offset of a missing comment
+#define IR2HID_LUT_NO_STRING 0xFFFF
+// Action index of an empty hash slot while loading, or of a row copy that didn't match
+#define IR2HID_LUT_NO_ACTION 0xFFFF
+
+// Longest cooldown_ms, the column is optional
+#define IR2HID_LUT_COOLDOWN_MAX 60000
+
+// Most codes in one cycle list, e.g. 0x1E|0x1F|0x20
+#define IR2HID_LUT_CYCLE_MAX 8
+
+// Longest text action, in bytes of UTF-8
+#define IR2HID_LUT_TEXT_MAX 63
+
+// sys:<name> actions
+typedef struct {
+    const char* name;
+    uint16_t usage;
+} IR2HIDSystemUsage;
+
+extern const IR2HIDSystemUsage ir2hid_system_usages[];
+extern const size_t ir2hid_system_usage_count;
+
+// Operands of an IrTransmit action: protocol, address low/high, command low/high
+#define IR2HID_LUT_IR_OPERANDS 5
+
+typedef enum {
+    IR2HIDActionTypeKeyboard, // code: usage in the low byte, KEY_MOD_* in the high byte
+    IR2HIDActionTypeCycle, // followed by count steps, each press sends the next one
+    IR2HIDActionTypeCycleStep, // code: as for Keyboard
+    IR2HIDActionTypeIrTransmit, // followed by IR2HID_LUT_IR_OPERANDS operands, relays an IR code
+    IR2HIDActionTypeOperand, // code: 16 bits of the action before it
+    IR2HIDActionTypeText, // code: string pool offset of UTF-8 text typed with the LUT's layout
+    IR2HIDActionTypeSystem, // code: Consumer page usage sent in its own report, e.g. sleep
+} IR2HIDActionType;
+
+// What a row does, shared by every row that maps to the same thing
+typedef struct {
+    uint8_t type; // IR2HIDActionType
+    uint8_t count; // Cycle: number of steps, IrTransmit: number of operands
+    uint16_t code;
+    uint16_t comment; // hid_key_comment of the first row using it
+    uint16_t cooldown; // ms before a row can fire it again, 0 for none
+} IR2HIDAction;
+
+// Per row data, parallel to the sorted keys
+typedef struct {
+    uint16_t action; // index into the action table
+    uint16_t line; // line of lut.csv the row came from
+    uint16_t ir_comment; // string pool offset
+} IR2HIDLutRow;
+
+typedef struct IR2HIDLutPages IR2HIDLutPages;
+
+// Tuning from the "@key,value" lines of lut.csv, kept in lut.bin too. Read once
+// by the loader and applied at startup, each has a default when absent.
+typedef struct {
+    IR2HIDLayout layout; // @layout: host keyboard layout text actions are typed for
+    bool early_nec; // @early_nec,on: act on NEC codes before their frame ends, see ir2hid_ir_rx.h
+    bool dispatch_thread; // @dispatch,thread|loop: where lookups and HID reports start out
+    uint16_t event_queue; // @event_queue: depth of the main loop's event queue
+    uint16_t debounce_ms; // @debounce_ms: same code within this is dropped
+    uint16_t min_press_ms; // @min_press_ms: time a key is held before its release
+    uint16_t redraw_ms; // @redraw_ms: at most one signal redraw per interval
+    uint16_t repeat_delay_ms; // @repeat_delay_ms: held button auto-repeat after this, 0 off
+    uint16_t repeat_ms; // @repeat_ms: auto-repeat interval
+} IR2HIDLutSettings;
+
+typedef struct {
+    // Single allocation: keys, fire ticks, rows, actions, then the string pool
+    void* arena;
+    IR2HIDKey* keys; // sorted, one per row, the search index
+    uint32_t* fired; // per row tick it last fired (0 never), NULL without cooldowns
+    IR2HIDLutRow* rows;
+    size_t count;
+    IR2HIDAction* actions; // deduplicated
+    size_t action_count;
+    const char* strings; // deduplicated comment strings
+    size_t strings_size;
+    uint8_t* states; // per row cycle position, NULL without cycle actions
+    bool states_dirty; // changed since loaded from IR2HID_LUT_STATE_PATH
+
+    IR2HIDLutSettings settings;
+
+    // Paged mode: keys and rows stay in lut.bin, only actions and strings are in the arena
+    IR2HIDLutPages* pages; // NULL when the whole LUT is in RAM
+
+    // Load diagnostics
+    size_t duplicates; // same key and same mapping as an earlier row
+    size_t conflicts; // same key but a different mapping, the earlier row wins
+    uint16_t first_issue_line; // first dropped row, 0 if none
+    uint16_t first_issue_kept_line; // row that was kept instead of it
+    uint32_t load_cycles; // CPU cycles for the whole parse
+    uint32_t build_cycles; // of which sorting, deduplication and final layout
+} IR2HIDLut;
+
+// Text shown on screen for a received signal
+typedef struct {
+    char proto[32];
+    char addr[32];
+    char cmd[32];
+    char comment[64]; // empty if the row has no comments
+} IR2HIDSignalText;
+
+typedef enum {
+    IR2HIDLutStatusOk,
+    IR2HIDLutStatusNotFound,
+    IR2HIDLutStatusInvalid, // empty, too large or no valid rows
+    IR2HIDLutStatusOutdated, // lut.bin from an older lut2bin.py
+} IR2HIDLutStatus;
+
+// A row dropped because an earlier row has the same key
+typedef struct {
+    IR2HIDKey key;
+    uint16_t line;
+    uint16_t kept_line;
+    const IR2HIDAction* action; // same pointer as kept_action for a plain duplicate
+    const IR2HIDAction* kept_action;
+    const char* strings; // string pool the actions' comments and texts point into
+} IR2HIDLutIssue;
+
+typedef void (*IR2HIDLutIssueCallback)(void* context, const IR2HIDLutIssue* issue);
+
+static inline IR2HIDKey
+    ir2hid_key_pack(InfraredProtocol protocol, uint32_t address, uint32_t command) {
+    return ((IR2HIDKey)(uint8_t)protocol << 56) | ((IR2HIDKey)address << 24) |
+           (command & IR2HID_KEY_COMMAND_MAX);
+}
+
+static inline InfraredProtocol ir2hid_key_protocol(IR2HIDKey key) {
+    return (InfraredProtocol)(key >> 56);
+}
+
+static inline uint32_t ir2hid_key_address(IR2HIDKey key) {
+    return (uint32_t)(key >> 24);
+}
+
+static inline uint32_t ir2hid_key_command(IR2HIDKey key) {
+    return (uint32_t)(key & IR2HID_KEY_COMMAND_MAX);
+}
+
+// Pack a received message, false if it can't be represented (and so can't be in any LUT)
+bool ir2hid_key_from_message(const InfraredMessage* msg, IR2HIDKey* key);
+
+// A CSV column as found by the tokenizer, not NUL-terminated unless noted
+typedef struct {
+    const char* start;
+    size_t len;
+} IR2HIDCsvField;
+
+// Split a CSV line into fields in a single pass. Each separator is replaced
+// by NUL so every field is also usable as a C string. Returns the field count.
+size_t ir2hid_csv_split(char* line, IR2HIDCsvField* fields, size_t max_fields);
+
+// Parse a hex column with optional 0x/0X prefix, up to 8 significant digits
+bool ir2hid_parse_hex_field(const IR2HIDCsvField* field, uint32_t* out);
+
+// Parse CSV text in place into a sorted, deduplicated LUT. buf must be NUL-terminated at len.
+// issue_callback may be NULL.
+bool ir2hid_lut_parse(
+    IR2HIDLut* lut,
+    char* buf,
+    size_t len,
+    IR2HIDLutIssueCallback issue_callback,
+    void* context);
+
+// Apply "@key,value" directive lines, the @ is optional. Unknown keys and values
+// out of range are ignored, the setting keeps its previous value.
+void ir2hid_lut_apply_settings(IR2HIDLut* lut, char* text);
+
+void ir2hid_lut_settings_default(IR2HIDLutSettings* settings);
+
+// Load the LUT from the SD card: lut.bin paged if present, else lut.csv into RAM.
+// Rows dropped from lut.csv are written to IR2HID_LUT_LOG_PATH.
+IR2HIDLutStatus ir2hid_lut_load(IR2HIDLut* lut);
+
+void ir2hid_lut_free(IR2HIDLut* lut);
+
+// Format a received signal and the row it matched (NULL if unmapped) for display
+void ir2hid_lut_format_signal(
+    const IR2HIDLut* lut,
+    const InfraredMessage* msg,
+    const IR2HIDLutRow* row,
+    IR2HIDSignalText* text);
+
+// Comment or text for a pool offset, NULL for IR2HID_LUT_NO_STRING. Always in RAM
+// (paged too), so it's safe from the draw callback and the dispatch thread.
+const char* ir2hid_lut_comment(const IR2HIDLut* lut, uint16_t offset);
+
+// Binary search over the sorted keys, index addresses keys and rows. In RAM LUTs only.
+bool ir2hid_lut_find(const IR2HIDLut* lut, IR2HIDKey key, size_t* index);
+
+// Copy of the row matching key and its index, works for both RAM and paged LUTs
+bool ir2hid_lut_lookup(const IR2HIDLut* lut, IR2HIDKey key, IR2HIDLutRow* row, uint32_t* index);
+
+// Rows with key's protocol and address whose command matches key's in the bits of
+// command_mask, a range search over the sorted keys. Returns 0, 1 or 2 for two or
+// more, match is the key of the first. Both RAM and paged LUTs.
+size_t ir2hid_lut_match_prefix(
+    const IR2HIDLut* lut,
+    IR2HIDKey key,
+    uint32_t command_mask,
+    IR2HIDKey* match);
+
+// HID code to send for a matched row. A cycle sends its current step and moves
+// the row on to the next one, the state is one byte indexed by row.
+uint16_t ir2hid_lut_press(IR2HIDLut* lut, const IR2HIDLutRow* row, uint32_t index);
+
+// IR code an IrTransmit row relays, false for other rows
+bool ir2hid_lut_ir_message(
+    const IR2HIDLut* lut,
+    const IR2HIDLutRow* row,
+    InfraredMessage* message);
+
+bool ir2hid_lut_has_cycles(const IR2HIDAction* actions, size_t count);
+
+bool ir2hid_lut_has_cooldowns(const IR2HIDAction* actions, size_t count);
+
+// True while a matched row is inside its cooldown at tick now. One compare on the
+// row's fire tick.
+bool ir2hid_lut_cooling_down(
+    const IR2HIDLut* lut,
+    const IR2HIDLutRow* row,
+    uint32_t index,
+    uint32_t now);
+
+// The row's action went out at tick now, its cooldown starts over
+void ir2hid_lut_fire(IR2HIDLut* lut, const IR2HIDLutRow* row, uint32_t index, uint32_t now);
+
+// Write the cycle positions to IR2HID_LUT_STATE_PATH if they changed
+void ir2hid_lut_save_state(IR2HIDLut* lut);
+
+static inline const IR2HIDAction* ir2hid_lut_row_action(const IR2HIDLut* lut, size_t index) {
+    return &lut->actions[lut->rows[index].action];
+}
+
+static inline const IR2HIDAction* ir2hid_lut_action(const IR2HIDLut* lut, const IR2HIDLutRow* row) {
+    return &lut->actions[row->action];
+}
@@ -0,0 +1,442 @@
+#include "ir2hid_lut_pages.h"
+
+#include <furi_hal.h>
+#include <storage/storage.h>
+#include <string.h>
+
+#define IR2HID_LUT_PAGE_NONE UINT32_MAX
+#define IR2HID_LUT_NO_PROTOCOL 0xFF
+#define IR2HID_LUT_SETTINGS_MAX 256
+
+_Static_assert(sizeof(IR2HIDLutBinHeader) == 48, "lut.bin header layout");
+_Static_assert(sizeof(IR2HIDAction) == 8, "lut.bin action layout");
+_Static_assert(sizeof(IR2HIDLutRow) == 6, "lut.bin row layout");
+
+typedef struct {
+    uint32_t page; // IR2HID_LUT_PAGE_NONE if empty
+    uint32_t last_use; // 0 if empty, evicted first
+    uint8_t* data;
+} IR2HIDLutPageSlot;
+
+struct IR2HIDLutPages {
+    Storage* storage;
+    File* file;
+    FuriMutex* mutex; // file and cache, lookups and key reads only
+
+    uint32_t page_rows;
+    uint32_t page_count;
+    uint32_t count; // rows
+    size_t page_size; // bytes
+    size_t slot_size; // page_size rounded up to keep every cached page 8 byte aligned
+    uint32_t pages_offset;
+    IR2HIDKey* directory;
+
+    // Compressed file: block offsets and a buffer for the largest block
+    uint32_t* block_offsets; // NULL if uncompressed
+    uint8_t* block;
+    uint8_t protocol_map[InfraredProtocolMAX]; // firmware protocol to file index
+    uint8_t protocol_fw[UINT8_MAX + 1]; // and back
+
+    IR2HIDLutPageSlot cache[IR2HID_LUT_PAGE_CACHE_SIZE];
+    uint8_t* cache_data;
+    uint32_t use_clock;
+    uint32_t hits;
+    uint32_t reads;
+};
+
+// --- Loading ---
+
+static bool ir2hid_lut_pages_read_at(IR2HIDLutPages* pages, uint32_t offset, void* buf, size_t size) {
+    return storage_file_seek(pages->file, offset, true) &&
+           storage_file_read(pages->file, buf, size) == size;
+}
+
+// Skip index after the directory, then one buffer sized for the largest block
+static bool
+    ir2hid_lut_pages_read_blocks(IR2HIDLutPages* pages, const IR2HIDLutBinHeader* header) {
+    const size_t size = (header->page_count + 1) * sizeof(uint32_t);
+    pages->block_offsets = malloc(size);
+    if(!pages->block_offsets ||
+       !ir2hid_lut_pages_read_at(
+           pages,
+           header->directory_offset + header->page_count * sizeof(IR2HIDKey),
+           pages->block_offsets,
+           size)) {
+        return false;
+    }
+
+    uint32_t largest = 0;
+    for(size_t i = 0; i < header->page_count; i++) {
+        if(pages->block_offsets[i + 1] < pages->block_offsets[i]) return false;
+        largest = MAX(largest, pages->block_offsets[i + 1] - pages->block_offsets[i]);
+    }
+    // Worst case is 10 + 3 * 3 bytes per row
+    if(largest == 0 || largest > pages->page_rows * 19U) return false;
+
+    pages->block = malloc(largest);
+    return pages->block != NULL;
+}
+
+static bool ir2hid_lut_pages_read_protocols(
+    IR2HIDLutPages* pages,
+    const IR2HIDLutBinHeader* header) {
+    memset(pages->protocol_map, IR2HID_LUT_NO_PROTOCOL, sizeof(pages->protocol_map));
+    memset(pages->protocol_fw, IR2HID_LUT_NO_PROTOCOL, sizeof(pages->protocol_fw));
+    if(header->protocol_count == 0) return true;
+
+    const size_t size = header->protocol_count * IR2HID_LUT_BIN_NAME_SIZE;
+    char* names = malloc(size);
+    if(!names) return false;
+
+    bool ok = ir2hid_lut_pages_read_at(pages, header->protocols_offset, names, size);
+    for(size_t i = 0; ok && i < header->protocol_count; i++) {
+        char* name = &names[i * IR2HID_LUT_BIN_NAME_SIZE];
+        name[IR2HID_LUT_BIN_NAME_SIZE - 1] = '\0';
+        // Protocols this firmware doesn't know just never match
+        InfraredProtocol proto = infrared_get_protocol_by_name(name);
+        if(infrared_is_protocol_valid(proto) && proto < InfraredProtocolMAX) {
+            pages->protocol_map[proto] = (uint8_t)i;
+            pages->protocol_fw[i] = (uint8_t)proto;
+        }
+    }
+
+    free(names);
+    return ok;
+}
+
+static bool ir2hid_lut_pages_header_valid(const IR2HIDLutBinHeader* header) {
+    return header->magic == IR2HID_LUT_BIN_MAGIC &&
+           (header->version == IR2HID_LUT_BIN_VERSION ||
+            header->version == IR2HID_LUT_BIN_VERSION_COMPRESSED) &&
+           header->page_rows > 0 && header->page_rows <= IR2HID_LUT_PAGE_ROWS_MAX &&
+           header->count > 0 &&
+           header->page_count == (header->count + header->page_rows - 1) / header->page_rows &&
+           header->protocol_count < IR2HID_LUT_NO_PROTOCOL &&
+           header->strings_size <= IR2HID_LUT_NO_STRING;
+}
+
+IR2HIDLutStatus ir2hid_lut_pages_load(IR2HIDLut* lut, const char* path) {
+    const uint32_t load_start = DWT->CYCCNT;
+
+    IR2HIDLutPages* pages = malloc(sizeof(IR2HIDLutPages));
+    memset(pages, 0, sizeof(IR2HIDLutPages));
+    pages->storage = furi_record_open(RECORD_STORAGE);
+    pages->file = storage_file_alloc(pages->storage);
+    pages->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    lut->pages = pages;
+
+    if(!storage_file_open(pages->file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        ir2hid_lut_pages_free(lut);
+        return IR2HIDLutStatusNotFound;
+    }
+
+    IR2HIDLutBinHeader header;
+    bool ok = ir2hid_lut_pages_read_at(pages, 0, &header, sizeof(header));
+    // Older layouts aren't read, they only need converting again
+    if(ok && header.magic == IR2HID_LUT_BIN_MAGIC && header.version < IR2HID_LUT_BIN_VERSION) {
+        ir2hid_lut_pages_free(lut);
+        return IR2HIDLutStatusOutdated;
+    }
+    ok = ok && ir2hid_lut_pages_header_valid(&header) &&
+         ir2hid_lut_pages_read_protocols(pages, &header);
+
+    if(ok) {
+        pages->page_rows = header.page_rows;
+        pages->page_count = header.page_count;
+        pages->count = header.count;
+        pages->page_size = header.page_rows * (sizeof(IR2HIDKey) + sizeof(IR2HIDLutRow));
+        pages->slot_size = (pages->page_size + sizeof(IR2HIDKey) - 1) & ~(sizeof(IR2HIDKey) - 1);
+        pages->pages_offset = header.pages_offset;
+
+        // Resident part: directory, actions and strings, and the page cache. Strings
+        // stay in RAM so comments and texts never wait for the SD card, plus a NUL
+        // in case the last one isn't terminated.
+        pages->directory = malloc(header.page_count * sizeof(IR2HIDKey));
+        lut->arena = malloc(header.action_count * sizeof(IR2HIDAction) + header.strings_size + 1);
+        pages->cache_data = malloc(pages->slot_size * IR2HID_LUT_PAGE_CACHE_SIZE);
+        ok = pages->directory && lut->arena && pages->cache_data;
+    }
+    char* strings = ok ? (char*)lut->arena + header.action_count * sizeof(IR2HIDAction) : NULL;
+    ok = ok &&
+         ir2hid_lut_pages_read_at(
+             pages,
+             header.directory_offset,
+             pages->directory,
+             header.page_count * sizeof(IR2HIDKey)) &&
+         ir2hid_lut_pages_read_at(
+             pages, header.actions_offset, lut->arena, header.action_count * sizeof(IR2HIDAction)) &&
+         ir2hid_lut_pages_read_at(pages, header.strings_offset, strings, header.strings_size);
+    if(ok && header.version == IR2HID_LUT_BIN_VERSION_COMPRESSED) {
+        ok = ir2hid_lut_pages_read_blocks(pages, &header);
+    }
+
+    if(!ok) {
+        if(lut->arena) free(lut->arena);
+        lut->arena = NULL;
+        ir2hid_lut_pages_free(lut);
+        return IR2HIDLutStatusInvalid;
+    }
+
+    for(size_t i = 0; i < IR2HID_LUT_PAGE_CACHE_SIZE; i++) {
+        pages->cache[i].page = IR2HID_LUT_PAGE_NONE;
+        pages->cache[i].last_use = 0;
+        pages->cache[i].data = pages->cache_data + i * pages->slot_size;
+    }
+
+    // Cycle positions and fire ticks are the only per row data kept in RAM, and
+    // only if some action needs them. Without the fire ticks cooldowns are off.
+    if(ir2hid_lut_has_cycles(lut->arena, header.action_count)) {
+        lut->states = malloc(header.count);
+        if(lut->states) memset(lut->states, 0, header.count);
+    }
+    if(ir2hid_lut_has_cooldowns(lut->arena, header.action_count)) {
+        lut->fired = malloc(header.count * sizeof(uint32_t));
+        if(lut->fired) memset(lut->fired, 0, header.count * sizeof(uint32_t));
+    }
+
+    lut->count = header.count;
+    lut->actions = lut->arena;
+    lut->action_count = header.action_count;
+    strings[header.strings_size] = '\0';
+    lut->strings = strings;
+    lut->strings_size = header.strings_size;
+
+    // Split in place, so a copy keeps the string pool intact
+    const char* stored = ir2hid_lut_comment(lut, header.settings);
+    if(stored) {
+        char settings[IR2HID_LUT_SETTINGS_MAX];
+        strlcpy(settings, stored, sizeof(settings));
+        ir2hid_lut_apply_settings(lut, settings);
+    }
+
+    lut->load_cycles = DWT->CYCCNT - load_start;
+    return IR2HIDLutStatusOk;
+}
+
+void ir2hid_lut_pages_free(IR2HIDLut* lut) {
+    IR2HIDLutPages* pages = lut->pages;
+    if(!pages) return;
+
+    if(storage_file_is_open(pages->file)) storage_file_close(pages->file);
+    storage_file_free(pages->file);
+    furi_record_close(RECORD_STORAGE);
+    furi_mutex_free(pages->mutex);
+    if(pages->directory) free(pages->directory);
+    if(pages->cache_data) free(pages->cache_data);
+    if(pages->block_offsets) free(pages->block_offsets);
+    if(pages->block) free(pages->block);
+    free(pages);
+    if(lut->states) free(lut->states);
+    if(lut->fired) free(lut->fired);
+    lut->states = NULL;
+    lut->fired = NULL;
+    lut->pages = NULL;
+}
+
+// --- Compressed Blocks ---
+
+static bool ir2hid_varint_read(const uint8_t** p, const uint8_t* end, uint64_t* out) {
+    uint64_t value = 0;
+    for(uint32_t shift = 0; shift < 64; shift += 7) {
+        if(*p == end) return false;
+        const uint8_t byte = *(*p)++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if(!(byte & 0x80)) {
+            *out = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Read a block and decode it into the same layout as an uncompressed page
+static bool ir2hid_lut_pages_decode(IR2HIDLutPages* pages, uint32_t page, uint8_t* out) {
+    const uint32_t start = pages->block_offsets[page];
+    const uint32_t size = pages->block_offsets[page + 1] - start;
+    if(!ir2hid_lut_pages_read_at(pages, pages->pages_offset + start, pages->block, size)) {
+        return false;
+    }
+
+    IR2HIDKey* keys = (IR2HIDKey*)out;
+    IR2HIDLutRow* rows = (IR2HIDLutRow*)(out + pages->page_rows * sizeof(IR2HIDKey));
+    const size_t count = MIN(pages->page_rows, pages->count - page * pages->page_rows);
+
+    const uint8_t* p = pages->block;
+    const uint8_t* end = pages->block + size;
+    IR2HIDKey key = pages->directory[page];
+    uint32_t line = 0;
+    for(size_t i = 0; i < count; i++) {
+        uint64_t key_delta, action, line_delta, comment;
+        if(!ir2hid_varint_read(&p, end, &key_delta) || !ir2hid_varint_read(&p, end, &action) ||
+           !ir2hid_varint_read(&p, end, &line_delta) || !ir2hid_varint_read(&p, end, &comment) ||
+           action > UINT16_MAX || comment > UINT16_MAX) {
+            return false;
+        }
+        key += key_delta;
+        line += (uint32_t)(line_delta >> 1) ^ -(uint32_t)(line_delta & 1);
+
+        keys[i] = key;
+        rows[i].action = (uint16_t)action;
+        rows[i].line = (uint16_t)line;
+        rows[i].ir_comment = (uint16_t)(comment - 1); // 0 wraps to IR2HID_LUT_NO_STRING
+    }
+    return true;
+}
+
+// --- Page Cache ---
+
+// Cached page data, or one read replacing the least recently used page. Mutex held.
+static const uint8_t* ir2hid_lut_pages_get(IR2HIDLutPages* pages, uint32_t page) {
+    IR2HIDLutPageSlot* victim = &pages->cache[0];
+    for(size_t i = 0; i < IR2HID_LUT_PAGE_CACHE_SIZE; i++) {
+        IR2HIDLutPageSlot* slot = &pages->cache[i];
+        if(slot->page == page) {
+            slot->last_use = ++pages->use_clock;
+            pages->hits++;
+            return slot->data;
+        }
+        if(slot->last_use < victim->last_use) victim = slot;
+    }
+
+    pages->reads++;
+    victim->page = IR2HID_LUT_PAGE_NONE;
+    victim->last_use = 0;
+    const bool ok = pages->block_offsets ?
+                        ir2hid_lut_pages_decode(pages, page, victim->data) :
+                        ir2hid_lut_pages_read_at(
+                            pages,
+                            pages->pages_offset + page * pages->page_size,
+                            victim->data,
+                            pages->page_size);
+    if(!ok) return NULL;
+    victim->page = page;
+    victim->last_use = ++pages->use_clock;
+    return victim->data;
+}
+
+bool ir2hid_lut_pages_find(
+    const IR2HIDLut* lut,
+    IR2HIDKey key,
+    IR2HIDLutRow* row,
+    uint32_t* index) {
+    IR2HIDLutPages* pages = lut->pages;
+
+    // Keys in the file use the file's protocol indexes
+    const uint32_t proto = ir2hid_key_protocol(key);
+    if(proto >= InfraredProtocolMAX || pages->protocol_map[proto] == IR2HID_LUT_NO_PROTOCOL) {
+        return false;
+    }
+    key = (key & ~((IR2HIDKey)0xFF << 56)) | ((IR2HIDKey)pages->protocol_map[proto] << 56);
+
+    // Last page starting at or before the key
+    size_t lo = 0;
+    size_t hi = pages->page_count;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(pages->directory[mid] <= key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if(lo == 0) return false;
+    const uint32_t page = lo - 1;
+
+    furi_mutex_acquire(pages->mutex, FuriWaitForever);
+
+    bool found = false;
+    const uint8_t* data = ir2hid_lut_pages_get(pages, page);
+    if(data) {
+        const IR2HIDKey* keys = (const IR2HIDKey*)data;
+        const IR2HIDLutRow* rows = (const IR2HIDLutRow*)(data + pages->page_rows * sizeof(IR2HIDKey));
+        lo = 0;
+        hi = MIN(pages->page_rows, lut->count - page * pages->page_rows);
+        while(lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if(keys[mid] == key) {
+                *row = rows[mid];
+                *index = page * pages->page_rows + mid;
+                // Don't trust the file with an index into the action table
+                found = row->action < lut->action_count;
+                break;
+            }
+            if(keys[mid] < key) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+    }
+
+    furi_mutex_release(pages->mutex);
+    return found;
+}
+
+bool ir2hid_lut_pages_lower_bound(const IR2HIDLut* lut, IR2HIDKey key, uint32_t* index) {
+    IR2HIDLutPages* pages = lut->pages;
+
+    const uint32_t proto = ir2hid_key_protocol(key);
+    if(proto >= InfraredProtocolMAX || pages->protocol_map[proto] == IR2HID_LUT_NO_PROTOCOL) {
+        return false;
+    }
+    key = (key & ~((IR2HIDKey)0xFF << 56)) | ((IR2HIDKey)pages->protocol_map[proto] << 56);
+
+    // Last page starting at or before the key, rows below the first page start it
+    size_t lo = 0;
+    size_t hi = pages->page_count;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(pages->directory[mid] <= key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    const uint32_t page = lo == 0 ? 0 : lo - 1;
+
+    furi_mutex_acquire(pages->mutex, FuriWaitForever);
+    const uint8_t* data = ir2hid_lut_pages_get(pages, page);
+    if(data) {
+        // Past the page's last row is the next page's first, which is above key
+        const IR2HIDKey* keys = (const IR2HIDKey*)data;
+        lo = 0;
+        hi = MIN(pages->page_rows, lut->count - page * pages->page_rows);
+        while(lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if(keys[mid] < key) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        *index = page * pages->page_rows + lo;
+    }
+    furi_mutex_release(pages->mutex);
+    return data != NULL;
+}
+
+bool ir2hid_lut_pages_key(const IR2HIDLut* lut, uint32_t index, IR2HIDKey* key) {
+    IR2HIDLutPages* pages = lut->pages;
+    if(index >= lut->count) return false;
+
+    furi_mutex_acquire(pages->mutex, FuriWaitForever);
+    const uint8_t* data = ir2hid_lut_pages_get(pages, index / pages->page_rows);
+    if(data) *key = ((const IR2HIDKey*)data)[index % pages->page_rows];
+    furi_mutex_release(pages->mutex);
+
+    if(!data) return false;
+    const uint8_t proto = pages->protocol_fw[ir2hid_key_protocol(*key)];
+    if(proto == IR2HID_LUT_NO_PROTOCOL) return false;
+    *key = (*key & ~((IR2HIDKey)0xFF << 56)) | ((IR2HIDKey)proto << 56);
+    return true;
+}
+
+InfraredProtocol ir2hid_lut_pages_protocol(const IR2HIDLut* lut, uint8_t index) {
+    const uint8_t proto = lut->pages->protocol_fw[index];
+    return proto == IR2HID_LUT_NO_PROTOCOL ? InfraredProtocolUnknown : (InfraredProtocol)proto;
+}
+
+void ir2hid_lut_pages_stats(const IR2HIDLut* lut, uint32_t* hits, uint32_t* reads) {
+    *hits = lut->pages->hits;
+    *reads = lut->pages->reads;
+}
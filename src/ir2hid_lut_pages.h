@@ -0,0 +1,81 @@
+#pragma once
+
+#include "ir2hid_lut.h"
+
+// --- Paged LUT ---
+//
+// lut.bin keeps the sorted table on the SD card, split into fixed size pages.
+// Only the first key of every page (the directory), the actions, the strings and
+// a small LRU cache of pages are resident, so a lookup costs at most one page read.
+//
+// File layout, little endian, written by tools/lut2bin.py:
+//   header      IR2HIDLutBinHeader
+//   protocols   protocol_count names of IR2HID_LUT_BIN_NAME_SIZE bytes. The protocol
+//               byte of every key is an index into this table, firmware enum values
+//               aren't stable enough to be stored.
+//   directory   page_count IR2HIDKey, first key of each page
+//   actions     action_count IR2HIDAction
+//   strings     strings_size bytes of NUL-terminated comments, texts and the
+//               settings: the @ directives of lut.csv, one "key,value" per line
+//   pages       page_count pages: page_rows IR2HIDKey, then page_rows IR2HIDLutRow,
+//               the last page is zero padded
+//
+// The compressed version (lut2bin.py --compress) stores every page as a variable size block:
+//   directory   as above, followed by page_count + 1 uint32_t block offsets
+//               relative to pages_offset, the skip index to any block
+//   pages       per row 4 LEB128 varints: key delta to the previous row (0 for the
+//               first, its key is in the directory), action, zigzag line delta,
+//               ir_comment + 1 (0 for none)
+// Blocks are decoded into the page cache, so a lookup decodes at most one block.
+
+#define IR2HID_LUT_BIN_MAGIC 0x42483249UL // "I2HB"
+// Versions 1 and 2 had 6 byte actions without the cooldown, 3 and 4 no settings
+#define IR2HID_LUT_BIN_VERSION 5
+#define IR2HID_LUT_BIN_VERSION_COMPRESSED 6
+#define IR2HID_LUT_BIN_NAME_SIZE 16
+
+#define IR2HID_LUT_PAGE_ROWS_MAX 256
+#define IR2HID_LUT_PAGE_CACHE_SIZE 4
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t page_rows;
+    uint32_t count; // rows
+    uint32_t page_count;
+    uint16_t protocol_count;
+    uint16_t action_count;
+    uint32_t strings_size;
+    uint32_t protocols_offset;
+    uint32_t directory_offset;
+    uint32_t actions_offset;
+    uint32_t strings_offset;
+    uint32_t pages_offset;
+    uint16_t settings; // string offset, IR2HID_LUT_NO_STRING if there are none
+    uint16_t reserved;
+} IR2HIDLutBinHeader;
+
+// Open lut.bin and load its directory, action table and strings. The file stays open until
+// ir2hid_lut_pages_free.
+IR2HIDLutStatus ir2hid_lut_pages_load(IR2HIDLut* lut, const char* path);
+
+void ir2hid_lut_pages_free(IR2HIDLut* lut);
+
+bool ir2hid_lut_pages_find(
+    const IR2HIDLut* lut,
+    IR2HIDKey key,
+    IR2HIDLutRow* row,
+    uint32_t* index);
+
+// Index of the first row with a key not below key, false if none can be (unknown
+// protocol or a read error)
+bool ir2hid_lut_pages_lower_bound(const IR2HIDLut* lut, IR2HIDKey key, uint32_t* index);
+
+// Key of the row at index, with the firmware's protocol value like a received key
+bool ir2hid_lut_pages_key(const IR2HIDLut* lut, uint32_t index, IR2HIDKey* key);
+
+// Firmware protocol of a protocol table index, used by IrTransmit operands
+InfraredProtocol ir2hid_lut_pages_protocol(const IR2HIDLut* lut, uint8_t index);
+
+// Page cache hits and SD card page reads (block decodes when compressed) so far
+void ir2hid_lut_pages_stats(const IR2HIDLut* lut, uint32_t* hits, uint32_t* reads);
@@ -0,0 +1,166 @@
+#include "ir2hid_timer_wheel.h"
+
+#define IR2HID_TIMER_WHEEL_MASK (IR2HID_TIMER_WHEEL_SLOTS - 1)
+
+struct IR2HIDTimerWheel {
+    FuriTimer* timer;
+    IR2HIDTimerWheelWakeup wakeup;
+    void* context;
+
+    // Each slot is a circular list with a sentinel head
+    IR2HIDTimer slots[IR2HID_TIMER_WHEEL_SLOTS];
+    uint32_t cursor; // next slot time (tick / resolution) to visit
+    size_t pending;
+
+    bool armed;
+    uint32_t armed_deadline;
+    bool advancing; // re-armed once at the end of an advance instead
+};
+
+// Signed distance, correct across tick counter wrap
+static inline int32_t ir2hid_tick_diff(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b);
+}
+
+static void ir2hid_timer_wheel_callback(void* context) {
+    IR2HIDTimerWheel* wheel = context;
+    wheel->wakeup(wheel->context);
+}
+
+static void ir2hid_timer_wheel_arm(IR2HIDTimerWheel* wheel, uint32_t deadline, uint32_t now) {
+    int32_t delay = ir2hid_tick_diff(deadline, now);
+    if(delay < 1) delay = 1;
+
+    furi_timer_start(wheel->timer, delay);
+    wheel->armed = true;
+    wheel->armed_deadline = deadline;
+}
+
+IR2HIDTimerWheel* ir2hid_timer_wheel_alloc(IR2HIDTimerWheelWakeup wakeup, void* context) {
+    IR2HIDTimerWheel* wheel = malloc(sizeof(IR2HIDTimerWheel));
+    memset(wheel, 0, sizeof(IR2HIDTimerWheel));
+
+    wheel->timer = furi_timer_alloc(ir2hid_timer_wheel_callback, FuriTimerTypeOnce, wheel);
+    wheel->wakeup = wakeup;
+    wheel->context = context;
+    wheel->cursor = furi_get_tick() / IR2HID_TIMER_WHEEL_RESOLUTION_TICKS;
+
+    for(size_t i = 0; i < IR2HID_TIMER_WHEEL_SLOTS; i++) {
+        wheel->slots[i].next = &wheel->slots[i];
+        wheel->slots[i].prev = &wheel->slots[i];
+    }
+
+    return wheel;
+}
+
+void ir2hid_timer_wheel_free(IR2HIDTimerWheel* wheel) {
+    furi_timer_stop(wheel->timer);
+    furi_timer_free(wheel->timer);
+    free(wheel);
+}
+
+void ir2hid_timer_init(IR2HIDTimer* timer, IR2HIDTimerCallback callback, void* context) {
+    timer->next = NULL;
+    timer->prev = NULL;
+    timer->deadline = 0;
+    timer->callback = callback;
+    timer->context = context;
+}
+
+static void ir2hid_timer_unlink(IR2HIDTimerWheel* wheel, IR2HIDTimer* timer) {
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->next = NULL;
+    timer->prev = NULL;
+    wheel->pending--;
+}
+
+void ir2hid_timer_schedule(IR2HIDTimerWheel* wheel, IR2HIDTimer* timer, uint32_t delay_ms) {
+    if(ir2hid_timer_is_pending(timer)) {
+        ir2hid_timer_unlink(wheel, timer);
+    }
+
+    const uint32_t now = furi_get_tick();
+    timer->deadline = now + furi_ms_to_ticks(delay_ms);
+
+    // Link at the tail of its slot
+    IR2HIDTimer* head =
+        &wheel->slots[(timer->deadline / IR2HID_TIMER_WHEEL_RESOLUTION_TICKS) &
+                      IR2HID_TIMER_WHEEL_MASK];
+    timer->next = head;
+    timer->prev = head->prev;
+    head->prev->next = timer;
+    head->prev = timer;
+    wheel->pending++;
+
+    // Only touch the FuriTimer when this becomes the earliest deadline
+    if(wheel->advancing) return;
+    if(!wheel->armed || ir2hid_tick_diff(timer->deadline, wheel->armed_deadline) < 0) {
+        ir2hid_timer_wheel_arm(wheel, timer->deadline, now);
+    }
+}
+
+void ir2hid_timer_cancel(IR2HIDTimerWheel* wheel, IR2HIDTimer* timer) {
+    // Leaves the FuriTimer armed, an early wakeup just finds nothing due
+    if(ir2hid_timer_is_pending(timer)) {
+        ir2hid_timer_unlink(wheel, timer);
+    }
+}
+
+void ir2hid_timer_wheel_advance(IR2HIDTimerWheel* wheel, uint32_t now) {
+    wheel->armed = false;
+    wheel->advancing = true;
+
+    // Move everything due to a local list first, so callbacks are free to
+    // schedule or cancel any timer, including ones that are also due
+    IR2HIDTimer expired;
+    expired.next = &expired;
+    expired.prev = &expired;
+
+    // Visit every slot time that passed, at most one full turn of the wheel
+    const uint32_t target = now / IR2HID_TIMER_WHEEL_RESOLUTION_TICKS;
+    uint32_t steps = target - wheel->cursor + 1;
+    if(steps > IR2HID_TIMER_WHEEL_SLOTS) steps = IR2HID_TIMER_WHEEL_SLOTS;
+
+    for(uint32_t i = 0; i < steps; i++) {
+        IR2HIDTimer* head = &wheel->slots[(target - i) & IR2HID_TIMER_WHEEL_MASK];
+        IR2HIDTimer* timer = head->next;
+        while(timer != head) {
+            IR2HIDTimer* next = timer->next;
+            // Slots are shared by every turn of the wheel, later turns stay
+            if(ir2hid_tick_diff(timer->deadline, now) <= 0) {
+                timer->prev->next = timer->next;
+                timer->next->prev = timer->prev;
+                timer->next = &expired;
+                timer->prev = expired.prev;
+                expired.prev->next = timer;
+                expired.prev = timer;
+            }
+            timer = next;
+        }
+    }
+    wheel->cursor = target;
+
+    while(expired.next != &expired) {
+        IR2HIDTimer* timer = expired.next;
+        ir2hid_timer_unlink(wheel, timer);
+        timer->callback(timer->context);
+    }
+
+    wheel->advancing = false;
+    if(wheel->pending == 0) return;
+
+    // Re-arm for the earliest remaining deadline
+    bool found = false;
+    uint32_t earliest = 0;
+    for(size_t i = 0; i < IR2HID_TIMER_WHEEL_SLOTS; i++) {
+        const IR2HIDTimer* head = &wheel->slots[i];
+        for(const IR2HIDTimer* timer = head->next; timer != head; timer = timer->next) {
+            if(!found || ir2hid_tick_diff(timer->deadline, earliest) < 0) {
+                earliest = timer->deadline;
+                found = true;
+            }
+        }
+    }
+    ir2hid_timer_wheel_arm(wheel, earliest, furi_get_tick());
+}
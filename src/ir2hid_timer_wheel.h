@@ -0,0 +1,49 @@
+#pragma once
+
+#include <furi.h>
+
+// --- Timer Wheel ---
+//
+// Every time based behaviour shares one hashed timer wheel driven by a single
+// FuriTimer. Timers are intrusive, scheduling and cancelling are O(1). The
+// FuriTimer is only armed for the earliest deadline, so nothing runs while idle
+// no matter how many timers are pending. Expired timers run in the thread that
+// calls ir2hid_timer_wheel_advance, never in the timer thread.
+
+#define IR2HID_TIMER_WHEEL_SLOTS 64 // power of 2
+#define IR2HID_TIMER_WHEEL_RESOLUTION_TICKS 4
+
+typedef void (*IR2HIDTimerCallback)(void* context);
+
+// Embedded by its owner, must stay valid while pending
+typedef struct IR2HIDTimer {
+    struct IR2HIDTimer* next;
+    struct IR2HIDTimer* prev;
+    uint32_t deadline; // tick
+    IR2HIDTimerCallback callback;
+    void* context;
+} IR2HIDTimer;
+
+typedef struct IR2HIDTimerWheel IR2HIDTimerWheel;
+
+// Called from the timer thread when the earliest deadline is due, the owner should
+// then call ir2hid_timer_wheel_advance from its own thread (e.g. post EventTypeTick)
+typedef void (*IR2HIDTimerWheelWakeup)(void* context);
+
+IR2HIDTimerWheel* ir2hid_timer_wheel_alloc(IR2HIDTimerWheelWakeup wakeup, void* context);
+
+void ir2hid_timer_wheel_free(IR2HIDTimerWheel* wheel);
+
+void ir2hid_timer_init(IR2HIDTimer* timer, IR2HIDTimerCallback callback, void* context);
+
+// (Re)schedule timer to expire in delay_ms
+void ir2hid_timer_schedule(IR2HIDTimerWheel* wheel, IR2HIDTimer* timer, uint32_t delay_ms);
+
+void ir2hid_timer_cancel(IR2HIDTimerWheel* wheel, IR2HIDTimer* timer);
+
+static inline bool ir2hid_timer_is_pending(const IR2HIDTimer* timer) {
+    return timer->prev != NULL;
+}
+
+// Run every timer due at tick `now` and re-arm for the next deadline
+void ir2hid_timer_wheel_advance(IR2HIDTimerWheel* wheel, uint32_t now);
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""Generate src/ir2hid_layouts.c, the keyboard layout tables for text actions.
+
+Every layout is a table of 256 HID codes indexed by Latin-1 character, in the
+format hid_command uses: usage in the low byte, modifiers in the high byte.
+Characters only typed through a dead key also carry IR2HID_LAYOUT_DEAD, the app
+presses space after them. 0 means the layout can't type the character.
+
+Usage: gen_layouts.py [src/ir2hid_layouts.c]
+"""
+
+import sys
+
+SHIFT = 0x0200  # KEY_MOD_LEFT_SHIFT
+ALTGR = 0x4000  # KEY_MOD_RIGHT_ALT
+DEAD = 0x8000  # right GUI bit, never needed by a layout
+
+LETTERS = {chr(ord("a") + i): 0x04 + i for i in range(26)}
+DIGITS = {str((i + 1) % 10): 0x1E + i for i in range(10)}
+COMMON = {"\n": 0x28, "\t": 0x2B, " ": 0x2C}
+
+# Per layout: usage -> (plain, shift, altgr), a leading "~" marks a dead key
+US = {
+    0x1E: ("1", "!"), 0x1F: ("2", "@"), 0x20: ("3", "#"), 0x21: ("4", "$"),
+    0x22: ("5", "%"), 0x23: ("6", "^"), 0x24: ("7", "&"), 0x25: ("8", "*"),
+    0x26: ("9", "("), 0x27: ("0", ")"), 0x2D: ("-", "_"), 0x2E: ("=", "+"),
+    0x2F: ("[", "{"), 0x30: ("]", "}"), 0x31: ("\\", "|"), 0x33: (";", ":"),
+    0x34: ("'", '"'), 0x35: ("`", "~"), 0x36: (",", "<"), 0x37: (".", ">"),
+    0x38: ("/", "?"),
+}
+
+UK = dict(US)
+UK.update({
+    0x1F: ("2", '"'), 0x20: ("3", "£"), 0x34: ("'", "@"), 0x32: ("#", "~"),
+    0x35: ("`", "¬", "¦"), 0x64: ("\\", "|"),
+})
+del UK[0x31]
+
+DE = {
+    0x1E: ("1", "!"), 0x1F: ("2", '"', "²"), 0x20: ("3", "§", "³"),
+    0x21: ("4", "$"), 0x22: ("5", "%"), 0x23: ("6", "&"), 0x24: ("7", "/", "{"),
+    0x25: ("8", "(", "["), 0x26: ("9", ")", "]"), 0x27: ("0", "=", "}"),
+    0x2D: ("ß", "?", "\\"), 0x2E: ("~´", "~`"), 0x2F: ("ü", "Ü"),
+    0x30: ("+", "*", "~"), 0x32: ("#", "'"), 0x33: ("ö", "Ö"),
+    0x34: ("ä", "Ä"), 0x35: ("~^", "°"), 0x36: (",", ";"),
+    0x37: (".", ":"), 0x38: ("-", "_"), 0x64: ("<", ">", "|"),
+    0x14: ("q", "Q", "@"), 0x10: ("m", "M", "µ"),
+    # QWERTZ
+    0x1C: ("z", "Z"), 0x1D: ("y", "Y"),
+}
+
+FR = {
+    0x1E: ("&", "1"), 0x1F: ("é", "2", "~~"), 0x20: ('"', "3", "#"),
+    0x21: ("'", "4", "{"), 0x22: ("(", "5", "["), 0x23: ("-", "6", "|"),
+    0x24: ("è", "7", "~`"), 0x25: ("_", "8", "\\"), 0x26: ("ç", "9", "^"),
+    0x27: ("à", "0", "@"), 0x2D: (")", "°", "]"), 0x2E: ("=", "+", "}"),
+    0x2F: ("~^", "~¨"), 0x30: ("$", "£", "¤"), 0x32: ("*", "µ"),
+    0x34: ("ù", "%"), 0x35: ("²",), 0x10: (",", "?"), 0x36: (";", "."),
+    0x37: (":", "/"), 0x38: ("!", "§"), 0x64: ("<", ">"),
+    # AZERTY
+    0x14: ("a", "A"), 0x04: ("q", "Q"), 0x1A: ("z", "Z"), 0x1D: ("w", "W"),
+    0x33: ("m", "M"),
+}
+
+LAYOUTS = (("US", "us", US), ("UK", "uk", UK), ("DE", "de", DE), ("FR", "fr", FR))
+
+
+def build(keys):
+    table = [0] * 256
+
+    def put(char, code):
+        dead = len(char) == 2 and char[0] == "~"
+        if dead:
+            char = char[1]
+        # First way found wins: plain keys before shift before AltGr
+        if ord(char) < 256 and table[ord(char)] == 0:
+            table[ord(char)] = code | (DEAD if dead else 0)
+
+    for char, usage in COMMON.items():
+        put(char, usage)
+    for level, mod in enumerate((0, SHIFT, ALTGR)):
+        for usage, chars in sorted(keys.items()):
+            if level < len(chars):
+                put(chars[level], usage | mod)
+        # Letters and digits not moved by the layout
+        for char, usage in list(LETTERS.items()) + list(DIGITS.items()):
+            if usage in keys or level > 1:
+                continue
+            put(char.upper() if level else char, usage | mod)
+    return table
+
+
+def main():
+    path = sys.argv[1] if len(sys.argv) > 1 else "src/ir2hid_layouts.c"
+    out = [
+        "// Generated by tools/gen_layouts.py, do not edit.",
+        "",
+        '#include "ir2hid_layouts.h"',
+        "",
+    ]
+    for name, _, keys in LAYOUTS:
+        table = build(keys)
+        out.append("static const uint16_t ir2hid_layout_%s[IR2HID_LAYOUT_CHARS] = {" % name.lower())
+        for i in range(0, 256, 8):
+            out.append("    " + " ".join("0x%04X," % v for v in table[i:i + 8]))
+        out.append("};")
+        out.append("")
+
+    out.append("const uint16_t* const ir2hid_layout_tables[IR2HIDLayoutCount] = {")
+    out += ["    [IR2HIDLayout%s] = ir2hid_layout_%s," % (n, n.lower()) for n, _, _ in LAYOUTS]
+    out.append("};")
+    out.append("")
+    out.append("const char* const ir2hid_layout_names[IR2HIDLayoutCount] = {")
+    out += ['    [IR2HIDLayout%s] = "%s",' % (n, s) for n, s, _ in LAYOUTS]
+    out.append("};")
+
+    with open(path, "w") as f:
+        f.write("\n".join(out) + "\n")
+
+
+if __name__ == "__main__":
+    main()
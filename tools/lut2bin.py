@@ -0,0 +1,327 @@
+#!/usr/bin/env python3
+"""Convert lut.csv to the paged lut.bin read by ir2hid.
+
+lut.bin is only needed for tables too large to load into RAM, copy it to
+/ext/apps_data/ir2hid/lut.bin next to (or instead of) lut.csv. Rows are
+validated, deduplicated and sorted like the app does when it loads lut.csv.
+
+With --compress every page is stored as a block of delta and varint encoded
+rows, typically less than half the size. The app decodes at most one block
+per lookup.
+
+Usage: lut2bin.py lut.csv lut.bin [--page-rows N] [--compress]
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = 0x42483249  # "I2HB"
+VERSION = 5  # 1 and 2 had actions without the cooldown, 3 and 4 no settings
+VERSION_COMPRESSED = 6
+NAME_SIZE = 16
+PAGE_ROWS_MAX = 256
+HEADER = struct.Struct("<IHHIIHHIIIIIIHH")
+
+NO_STRING = 0xFFFF
+NO_ACTION = 0xFFFF
+COMMAND_MAX = 0xFFFFFF
+COOLDOWN_MAX = 60000
+ACTION_KEYBOARD = 0
+ACTION_CYCLE = 1
+ACTION_CYCLE_STEP = 2
+ACTION_IR_TRANSMIT = 3
+ACTION_OPERAND = 4
+ACTION_TEXT = 5
+ACTION_SYSTEM = 6
+CYCLE_MAX = 8
+TEXT_MAX = 63
+SETTINGS_MAX = 255
+
+# sys:<name> Consumer page usages, like ir2hid_system_usages
+SYSTEM_USAGES = {"power": 0x30, "sleep": 0x32}
+
+# Protocol names known to the firmware's infrared library, rows using any other
+# name are dropped like the app does
+PROTOCOLS = (
+    "NEC", "NECext", "NEC42", "NEC42ext", "Samsung32", "RC6", "RC5", "RC5X", "SIRC",
+    "SIRC15", "SIRC20", "Kaseikyo", "RCA", "Pioneer",
+)
+
+
+def parse_hex(field):
+    """Same rules as ir2hid_parse_hex_field, None if invalid."""
+    s = field
+    if len(s) >= 2 and s[0] == "0" and s[1] in "xX":
+        s = s[2:]
+    while len(s) > 8 and s[0] == "0":
+        s = s[1:]
+    if not 0 < len(s) <= 8 or any(c not in "0123456789abcdefABCDEF" for c in s):
+        return None
+    return int(s, 16)
+
+
+def parse_cooldown(field):
+    """cooldown_ms, empty for none, None if invalid."""
+    if not field:
+        return 0
+    if len(field) > 10 or not all(c in "0123456789" for c in field) or int(field) > COOLDOWN_MAX:
+        return None
+    return int(field)
+
+
+def parse_hid(field):
+    """One code or a cycle list like 0x7F|0xE2, None if invalid."""
+    codes = [parse_hex(part) for part in field.split("|")]
+    if len(codes) > CYCLE_MAX or any(c is None or c > 0xFFFF or c & 0xFF == 0 for c in codes):
+        return None
+    return codes
+
+
+def parse_ir(field):
+    """ir:<protocol>:<address>:<command> relay target as (name, address, command), None if invalid."""
+    parts = field.split(":")
+    if len(parts) != 4 or parts[0] != "ir" or parts[1] not in PROTOCOLS:
+        return None
+    addr = parse_hex(parts[2])
+    cmd = parse_hex(parts[3])
+    if addr is None or cmd is None:
+        return None
+    return parts[1], addr, cmd
+
+
+def read_lines(path):
+    """(line number, text) of every line, CRLF counts as one break."""
+    with open(path, "rb") as f:
+        data = f.read().decode("utf-8", errors="replace")
+    line_no = 0
+    start = 0
+    i = 0
+    while i <= len(data):
+        c = data[i] if i < len(data) else "\0"
+        if c in "\r\n\0":
+            line_no += 1
+            text = data[start:i]
+            if c == "\r" and i + 1 < len(data) and data[i + 1] == "\n":
+                i += 1
+            yield line_no, text
+            start = i + 1
+        i += 1
+
+
+class Pool:
+    def __init__(self):
+        self.data = bytearray()
+        self.offsets = {}
+
+    def intern(self, text):
+        if not text:
+            return NO_STRING
+        if text in self.offsets:
+            return self.offsets[text]
+        encoded = text.encode("utf-8") + b"\0"
+        if len(self.data) + len(encoded) > NO_STRING:
+            return NO_STRING
+        offset = len(self.data)
+        self.data += encoded
+        self.offsets[text] = offset
+        return offset
+
+
+def load_csv(path):
+    protocols = []
+    actions = []  # (type, count, code, comment, cooldown), followed by cycle steps or IR operands
+    action_index = {}
+    pool = Pool()
+    records = []  # (key, line, action, ir_comment)
+    settings = []  # @ directives without the @
+
+    header = True
+    for line_no, text in read_lines(path):
+        if not text:
+            continue
+        if text[0] == "@":
+            settings.append(",".join(text[1:].split(",")[:2]))
+            continue
+        if header:
+            header = False
+            continue
+
+        cols = text.split(",")[:7]
+        if len(cols) < 4:
+            continue
+        name = cols[0]
+        if name not in PROTOCOLS:
+            print("line %u: unknown protocol %r, skipped" % (line_no, name), file=sys.stderr)
+            continue
+        addr = parse_hex(cols[1])
+        cmd = parse_hex(cols[2])
+        relay = parse_ir(cols[3]) if cols[3].startswith("ir:") else None
+        typed = cols[3][5:] if cols[3].startswith("text:") else None
+        if typed is not None and not 0 < len(typed.encode("utf-8")) <= TEXT_MAX:
+            continue
+        system = SYSTEM_USAGES.get(cols[3][4:]) if cols[3].startswith("sys:") else None
+        if cols[3].startswith("sys:") and system is None:
+            continue
+        codes = None if relay or typed or system else parse_hid(cols[3])
+        cooldown = parse_cooldown(cols[6]) if len(cols) > 6 else 0
+        if addr is None or cmd is None or cmd > COMMAND_MAX:
+            continue
+        if codes is None and relay is None and typed is None and system is None:
+            continue
+        if cooldown is None:
+            continue
+
+        for used in (name, relay[0]) if relay else (name,):
+            if used not in protocols:
+                protocols.append(used)
+        proto = protocols.index(name)
+
+        if relay:
+            action_key = (relay, cooldown)
+        elif typed:
+            action_key = (("text", typed), cooldown)
+        elif system:
+            action_key = (("sys", system), cooldown)
+        else:
+            action_key = (tuple(codes), cooldown)
+        if action_key not in action_index:
+            comment = pool.intern(cols[5]) if len(cols) > 5 else NO_STRING
+            action_index[action_key] = len(actions)
+            if typed:
+                text_offset = pool.intern(typed)
+                if text_offset == NO_STRING:
+                    sys.exit("line %u: string pool full" % line_no)
+                actions.append((ACTION_TEXT, 0, text_offset, comment, cooldown))
+            elif system:
+                actions.append((ACTION_SYSTEM, 0, system, comment, cooldown))
+            elif relay:
+                # Protocol as a protocol table index, like the keys
+                _, relay_addr, relay_cmd = relay
+                operands = (protocols.index(relay[0]), relay_addr & 0xFFFF, relay_addr >> 16,
+                            relay_cmd & 0xFFFF, relay_cmd >> 16)
+                actions.append((ACTION_IR_TRANSMIT, len(operands), 0, comment, cooldown))
+                actions += [(ACTION_OPERAND, 0, op, NO_STRING, 0) for op in operands]
+            elif len(codes) == 1:
+                actions.append((ACTION_KEYBOARD, 0, codes[0], comment, cooldown))
+            else:
+                actions.append((ACTION_CYCLE, len(codes), 0, comment, cooldown))
+                actions += [(ACTION_CYCLE_STEP, 0, code, NO_STRING, 0) for code in codes]
+        ir_comment = pool.intern(cols[4]) if len(cols) > 4 else NO_STRING
+
+        key = (proto << 56) | (addr << 24) | cmd
+        records.append((key, min(line_no, 0xFFFF), action_index[action_key], ir_comment))
+
+    # First row wins, like the app
+    records.sort(key=lambda r: (r[0], r[1]))
+    rows = []
+    for r in records:
+        if rows and rows[-1][0] == r[0]:
+            kept = rows[-1]
+            kind = "duplicate of" if kept[2] == r[2] else "conflicts with"
+            print("line %u: %s line %u" % (r[1], kind, kept[1]), file=sys.stderr)
+            continue
+        rows.append(r)
+
+    if len(protocols) >= 0xFF or len(actions) >= NO_ACTION:
+        sys.exit("too many protocols or distinct actions")
+    settings_text = "\n".join(settings)
+    if len(settings_text.encode("utf-8")) > SETTINGS_MAX:
+        sys.exit("@ directives longer than %u bytes" % SETTINGS_MAX)
+    return protocols, actions, pool, rows, pool.intern(settings_text)
+
+
+def varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def encode_block(page):
+    """Delta and varint encoded rows, see ir2hid_lut_pages.h."""
+    out = bytearray()
+    prev_key = page[0][0]
+    prev_line = 0
+    for key, line, action, ir_comment in page:
+        line_delta = line - prev_line
+        out += varint(key - prev_key)
+        out += varint(action)
+        out += varint(line_delta << 1 if line_delta >= 0 else (-line_delta << 1) - 1)
+        out += varint((ir_comment + 1) & 0xFFFF)
+        prev_key = key
+        prev_line = line
+    return bytes(out)
+
+
+def write_bin(path, protocols, actions, strings, rows, page_rows, compress, settings):
+    page_count = (len(rows) + page_rows - 1) // page_rows
+
+    names = b"".join(p.encode("ascii").ljust(NAME_SIZE, b"\0") for p in protocols)
+    directory = b"".join(
+        struct.pack("<Q", rows[i * page_rows][0]) for i in range(page_count))
+    action_data = b"".join(struct.pack("<BBHHH", *a) for a in actions)
+
+    pages = bytearray()
+    offsets = [0]
+    for i in range(page_count):
+        page = rows[i * page_rows:(i + 1) * page_rows]
+        if compress:
+            pages += encode_block(page)
+            offsets.append(len(pages))
+            continue
+        keys = b"".join(struct.pack("<Q", r[0]) for r in page)
+        data = b"".join(struct.pack("<HHH", r[2], r[1], r[3]) for r in page)
+        pages += keys.ljust(page_rows * 8, b"\0") + data.ljust(page_rows * 6, b"\0")
+
+    if compress:
+        # Skip index, right after the directory
+        directory += b"".join(struct.pack("<I", o) for o in offsets)
+
+    protocols_offset = HEADER.size
+    directory_offset = protocols_offset + len(names)
+    actions_offset = directory_offset + len(directory)
+    strings_offset = actions_offset + len(action_data)
+    pages_offset = strings_offset + len(strings)
+
+    header = HEADER.pack(
+        MAGIC, VERSION_COMPRESSED if compress else VERSION, page_rows, len(rows), page_count, len(protocols), len(actions),
+        len(strings), protocols_offset, directory_offset, actions_offset, strings_offset,
+        pages_offset, settings, 0)
+
+    with open(path, "wb") as f:
+        f.write(header + names + directory + action_data + strings + pages)
+    return len(pages)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert lut.csv to a paged lut.bin")
+    parser.add_argument("csv")
+    parser.add_argument("bin")
+    parser.add_argument("--page-rows", type=int, default=64,
+                        help="rows per page, 1-%d (default 64)" % PAGE_ROWS_MAX)
+    parser.add_argument("--compress", action="store_true",
+                        help="delta and varint encode the pages")
+    args = parser.parse_args()
+
+    if not 0 < args.page_rows <= PAGE_ROWS_MAX:
+        sys.exit("--page-rows must be 1-%d" % PAGE_ROWS_MAX)
+
+    protocols, actions, pool, rows, settings = load_csv(args.csv)
+    if not rows:
+        sys.exit("no valid rows")
+    strings = pool.data
+    pages_size = write_bin(
+        args.bin, protocols, actions, strings, rows, args.page_rows, args.compress, settings)
+    print("%u rows, %u pages of %u (%u bytes), %u actions, %u bytes of comments" % (
+        len(rows), (len(rows) + args.page_rows - 1) // args.page_rows, args.page_rows,
+        pages_size, len(actions), len(strings)))
+
+
+if __name__ == "__main__":
+    main()